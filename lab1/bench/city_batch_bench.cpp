@@ -0,0 +1,90 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "../src/game/game_engine.h"
+#include "../src/simulation/city_batch.h"
+#include "../src/utils/random.h"
+
+namespace {
+
+constexpr std::uint64_t kSeed = 42;
+
+struct Outcome {
+    std::uint64_t city_years = 0;
+    std::vector<GameState> final_states;
+};
+
+template<typename Fn>
+Outcome Measure(const char* name, Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    Outcome outcome = fn();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << static_cast<double>(outcome.city_years) / elapsed.count() << " city-years/s\n";
+    return outcome;
+}
+
+bool SameStates(const std::vector<GameState>& a, const std::vector<GameState>& b) {
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (a[i].year_ != b[i].year_ || a[i].population_ != b[i].population_ || a[i].acres_ != b[i].acres_ ||
+            a[i].wheat_ != b[i].wheat_) {
+            return false;
+        }
+    }
+    return a.size() == b.size();
+}
+
+}  // namespace
+
+// Usage: city_batch_bench [cities] [batches]
+int main(const int argc, char* argv[]) {
+    const std::size_t cities = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4096;
+    const std::size_t batches = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 200;
+    const UserInputData policy(0, 0, 0, 2000);
+
+    const Outcome engines = Measure("GameEngine per city", [&] {
+        Outcome outcome;
+        for (std::size_t batch = 0; batch < batches; ++batch) {
+            outcome.final_states.clear();
+            for (std::size_t city = 0; city < cities; ++city) {
+                GameEngine engine(GameState(kSeed ^ SplitMix64(batch * cities + city)));
+                engine.PlayReign([&policy](const GameEngine& state) { return state.ClampDecision(policy); });
+                outcome.city_years += engine.game_state().year_;
+                outcome.final_states.push_back(engine.game_state());
+            }
+        }
+        return outcome;
+    });
+
+    const auto run_batch = [&](const bool vectorized) {
+        Outcome outcome;
+        CityBatch city_batch;
+        city_batch.SetVectorized(vectorized);
+        for (std::size_t batch = 0; batch < batches; ++batch) {
+            city_batch.Reset(kSeed, batch * cities, cities);
+            city_batch.PlayReign(policy);
+            outcome.final_states.clear();
+            for (std::size_t city = 0; city < cities; ++city) {
+                outcome.final_states.push_back(city_batch.game_state(city));
+                outcome.city_years += outcome.final_states.back().year_;
+            }
+        }
+        return outcome;
+    };
+
+    const Outcome scalar = Measure("CityBatch, scalar", [&] { return run_batch(false); });
+    std::cout << "  same final states: " << (SameStates(engines.final_states, scalar.final_states) ? "yes" : "NO")
+              << '\n';
+    if (!CityBatch::IsVectorizationSupported()) {
+        std::cout << "AVX2 is not available\n";
+        return 0;
+    }
+    const Outcome avx2 = Measure("CityBatch, AVX2", [&] { return run_batch(true); });
+    std::cout << "  same final states: " << (SameStates(engines.final_states, avx2.final_states) ? "yes" : "NO")
+              << '\n';
+    return 0;
+}
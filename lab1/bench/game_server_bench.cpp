@@ -0,0 +1,151 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../src/file_system/file_manager.h"
+#include "../src/server/game_server.h"
+
+namespace {
+
+int Connect(const std::string& path) {
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    path.copy(address.sun_path, sizeof(address.sun_path) - 1);
+    if (fd >= 0 && connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool SendLine(const int fd, const std::string& line) {
+    const std::string data = line + '\n';
+    return send(fd, data.data(), data.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(data.size());
+}
+
+// Reads until the server asks something (every prompt ends with ": ") or hangs up.
+bool ReadPrompt(const int fd, std::string& text) {
+    text.clear();
+    char buffer[4096];
+    while (text.size() < 2 || text.compare(text.size() - 2, 2, ": ") != 0) {
+        const ssize_t count = recv(fd, buffer, sizeof(buffer), 0);
+        if (count <= 0) {
+            return false;
+        }
+        text.append(buffer, static_cast<std::size_t>(count));
+    }
+    return true;
+}
+
+// Plays one game as a bot that never saves, buys or sells land, and plants 1000 and eats 2000
+// bushels or as much as the prompt allows. True if the game ran to its verdict.
+bool PlayGame(const std::string& path, const std::uint64_t player_id) {
+    const int fd = Connect(path);
+    if (fd < 0) {
+        return false;
+    }
+    std::string text;
+    bool connected = ReadPrompt(fd, text) && SendLine(fd, std::to_string(player_id));
+    while (connected && ReadPrompt(fd, text)) {
+        std::string answer = "n";
+        if (text.find("(y/n)") == std::string::npos) {
+            const int limit = std::atoi(text.c_str() + text.rfind(' ', text.size() - 3) + 1);
+            const int wanted = text.find("засеять") != std::string::npos ? 1000
+                             : text.find("съесть") != std::string::npos ? 2000 : 0;
+            answer = std::to_string(std::min(limit, wanted));
+        }
+        connected = SendLine(fd, answer);
+    }
+    close(fd);
+    // The server hangs up right after the verdict.
+    return connected && !text.empty();
+}
+
+std::size_t ResidentBytes() {
+    std::size_t pages = 0;
+    std::size_t resident = 0;
+    std::ifstream("/proc/self/statm") >> pages >> resident;
+    return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+}  // namespace
+
+// Usage: game_server_bench [idle_sessions] [games]
+// Parks idle sessions on an in-process server, then has a bot play games while they wait.
+int main(const int argc, char* argv[]) {
+    const std::size_t idle_sessions = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 8000;
+    const std::uint64_t games = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2000;
+
+    rlimit limit{};
+    getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "game_server_bench";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    FileManager::SetSaveDirectory(directory);
+    const std::string path = (directory / "server.sock").string();
+    GameServer server(path);
+    if (!server.Open()) {
+        std::cerr << "Cannot listen on " << path << '\n';
+        return 1;
+    }
+    std::thread serving([&] { server.Run(); });
+
+    // Memory is measured over the second half of the sessions, past the one-off costs of the
+    // first connections such as the save store mapping and allocator arenas.
+    std::vector<int> idle;
+    std::string text;
+    std::size_t resident_at_half = 0;
+    for (std::uint64_t player = 1; idle.size() < idle_sessions; ++player) {
+        if (idle.size() == idle_sessions / 2) {
+            resident_at_half = ResidentBytes();
+        }
+        const int fd = Connect(path);
+        if (fd < 0 || !ReadPrompt(fd, text) || !SendLine(fd, std::to_string(player)) || !ReadPrompt(fd, text)) {
+            std::cerr << "Could only open " << idle.size() << " sessions\n";
+            if (fd >= 0) {
+                close(fd);
+            }
+            break;
+        }
+        idle.push_back(fd);
+    }
+    const std::size_t resident = ResidentBytes();
+    const std::size_t measured = std::max<std::size_t>(idle.size() - idle_sessions / 2, 1);
+    std::cout << idle.size() << " idle sessions, about "
+              << (resident - std::min(resident_at_half, resident)) / measured << " bytes each\n";
+
+    std::uint64_t finished = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::uint64_t game = 0; game < games; ++game) {
+        finished += PlayGame(path, idle_sessions + 1 + game);
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << finished << " of " << games << " games finished, "
+              << static_cast<double>(games) / elapsed.count() << " games/s\n";
+
+    for (const int fd : idle) {
+        close(fd);
+    }
+    server.Stop();
+    serving.join();
+    std::filesystem::remove_all(directory);
+    return finished == games ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include <filesystem>
+
+#include <benchmark/benchmark.h>
+
+#include "../src/file_system/autosave_journal.h"
+#include "../src/file_system/file_manager.h"
+#include "../src/file_system/save_record.h"
+#include "../src/game/game_engine.h"
+#include "../src/simulation/city_batch.h"
+
+namespace {
+
+const UserInputData kPolicy(0, 0, 1000, 2000);
+
+// An engine in its third year with the year's draws made, as a player would see it.
+GameEngine MidGame() {
+    GameEngine engine{GameState(7)};
+    engine.GenerateRandomParams();
+    for (int year = 0; year < 2; ++year) {
+        engine.PlayYear(engine.ClampDecision(kPolicy));
+    }
+    return engine;
+}
+
+void BM_GenerateRandomParams(benchmark::State& state) {
+    GameEngine engine = MidGame();
+    for (auto _ : state) {
+        engine.GenerateRandomParams();
+        benchmark::DoNotOptimize(engine);
+    }
+}
+BENCHMARK(BM_GenerateRandomParams);
+
+void BM_NextYear(benchmark::State& state) {
+    GameEngine decided = MidGame();
+    decided.UpdateCityState(decided.ClampDecision(kPolicy));
+    for (auto _ : state) {
+        GameEngine engine = decided;
+        benchmark::DoNotOptimize(engine.NextYear());
+    }
+}
+BENCHMARK(BM_NextYear);
+
+void BM_SaveRecordRoundTrip(benchmark::State& state) {
+    const GameEngine engine = MidGame();
+    GameEngine loaded;
+    for (auto _ : state) {
+        SaveRecord record = MakeSaveRecord(engine);
+        benchmark::DoNotOptimize(record);
+        benchmark::DoNotOptimize(ReadSaveRecord(record, loaded));
+    }
+}
+BENCHMARK(BM_SaveRecordRoundTrip);
+
+// Through the save file: write to a temporary file, fsync, rename, then read it back.
+void BM_SaveFileRoundTrip(benchmark::State& state) {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "hammurabi_bench";
+    std::filesystem::create_directories(directory);
+    FileManager::SetSaveDirectory(directory);
+    const GameEngine engine = MidGame();
+    for (auto _ : state) {
+        if (!FileManager::SaveGame(engine)) {
+            state.SkipWithError("cannot save");
+            break;
+        }
+        benchmark::DoNotOptimize(FileManager::TryLoadGame());
+    }
+    std::filesystem::remove_all(directory);
+}
+BENCHMARK(BM_SaveFileRoundTrip)->Unit(benchmark::kMicrosecond);
+
+// What a turn pays for the autosave journal; the writes and fdatasyncs happen on its own thread.
+void BM_AutosaveJournalRecordYear(benchmark::State& state) {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "hammurabi_bench";
+    std::filesystem::create_directories(directory);
+    AutosaveJournal journal;
+    if (!journal.Open(directory / "autosave.journal")) {
+        state.SkipWithError("cannot open the journal");
+        return;
+    }
+    const GameEngine engine = MidGame();
+    const UserInputData decision = engine.ClampDecision(kPolicy);
+    std::uint64_t player_id = 0;
+    for (auto _ : state) {
+        journal.RecordYear(++player_id % 1024 + 1, decision, engine);
+    }
+    if (!journal.Sync()) {
+        state.SkipWithError("cannot write the journal");
+    }
+    std::filesystem::remove_all(directory);
+}
+BENCHMARK(BM_AutosaveJournalRecordYear);
+
+void BM_FullGame(benchmark::State& state) {
+    std::uint64_t seed = 0;
+    for (auto _ : state) {
+        GameEngine engine{GameState(++seed)};
+        benchmark::DoNotOptimize(engine.PlayReign([](const GameEngine& current) {
+            return current.ClampDecision(kPolicy);
+        }));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FullGame);
+
+void BM_CityBatchGames(benchmark::State& state) {
+    const auto games = static_cast<std::size_t>(state.range(0));
+    CityBatch cities;
+    std::uint64_t first_game = 0;
+    for (auto _ : state) {
+        cities.Reset(0, first_game, games);
+        cities.PlayReign(kPolicy);
+        benchmark::DoNotOptimize(cities.game_state(0));
+        first_game += games;
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CityBatchGames)->Arg(4096)->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+
+BENCHMARK_MAIN();
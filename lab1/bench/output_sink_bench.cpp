@@ -0,0 +1,98 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../src/game/game_engine.h"
+#include "../src/game/game_io.h"
+#include "../src/io/output_sink.h"
+
+namespace {
+
+struct Status {
+    GameState state;
+    YearEvents events;
+};
+
+// GameIO::PrintStatus as it was: temporary strings from std::format and std::endl after each message.
+void LegacyPrintStatus(std::ostream& out, const GameState& game_state, const YearEvents& events) {
+    out << std::format("Мой повелитель, соизволь поведать тебе в году {}"
+                       " твоего высочайшего правления {} человек умерло от голода."
+                       " {} новых граждан прибыло в город. ",
+                       game_state.year_, events.starvation_deaths, events.new_citizens) << std::endl;
+    if (events.plague) {
+        out << " Чума уничтожила половину населения. " << std::endl;
+    }
+    out << std::format("Население города сейчас составляет {} человек. "
+                       "Мы собрали {} бушелей пшеницы, по {} бушелей с акра. "
+                       "Крысы уничтожили {} бушелей пшеницы. У нас есть {} бушелей пшеницы и {} акров земли. "
+                       "Цена акра земли составляет {} бушелей.\n",
+                       game_state.population_, events.harvest, events.wheat_per_acre,
+                       events.rats_ate, game_state.wheat_, game_state.acres_, events.land_price) << std::endl;
+}
+
+std::vector<Status> MakeStatuses(const std::size_t count) {
+    std::vector<Status> statuses;
+    const UserInputData policy(0, 0, 0, 2000);
+    for (std::uint64_t game = 0; statuses.size() < count; ++game) {
+        GameEngine engine{GameState(game)};
+        engine.GenerateRandomParams();
+        while (!engine.IsGameOver() && statuses.size() < count) {
+            const YearEvents events = engine.PlayYear(engine.ClampDecision(policy));
+            statuses.push_back({engine.game_state(), events});
+        }
+    }
+    return statuses;
+}
+
+template<typename Fn>
+void Measure(const char* name, const std::uint64_t lines, Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << static_cast<double>(lines) / elapsed.count() << " status lines/s\n";
+}
+
+}  // namespace
+
+// Usage: output_sink_bench [lines] [output_path]
+int main(const int argc, char* argv[]) {
+    const std::uint64_t lines = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    const std::string path = argc > 2 ? argv[2] : "/dev/null";
+    const std::vector<Status> statuses = MakeStatuses(4096);
+
+    Measure("std::format + std::endl to std::ofstream", lines, [&] {
+        std::ofstream out(path, std::ios::binary);
+        for (std::uint64_t i = 0; i < lines; ++i) {
+            const Status& status = statuses[i % statuses.size()];
+            LegacyPrintStatus(out, status.state, status.events);
+        }
+    });
+
+    Measure("GameIO::PrintStatus to FileSink", lines, [&] {
+        FileSink sink(path);
+        GameIO::SetOutput(&sink);
+        for (std::uint64_t i = 0; i < lines; ++i) {
+            const Status& status = statuses[i % statuses.size()];
+            GameIO::PrintStatus(status.state, status.events);
+        }
+        GameIO::SetOutput(nullptr);
+    });
+
+    Measure("GameIO::PrintStatus to NullSink", lines, [&] {
+        NullSink sink;
+        GameIO::SetOutput(&sink);
+        for (std::uint64_t i = 0; i < lines; ++i) {
+            const Status& status = statuses[i % statuses.size()];
+            GameIO::PrintStatus(status.state, status.events);
+        }
+        GameIO::SetOutput(nullptr);
+    });
+    return 0;
+}
@@ -0,0 +1,98 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <unistd.h>
+
+#include "../src/game/game.h"
+#include "../src/game/game_engine.h"
+#include "../src/game/game_io.h"
+#include "../src/io/output_sink.h"
+
+namespace {
+
+std::size_t ResidentBytes() {
+    std::size_t pages = 0;
+    std::size_t resident = 0;
+    std::ifstream("/proc/self/statm") >> pages >> resident;
+    return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+void AnswerNumber(Game& game, const int value) {
+    char text[16];
+    const auto end = std::to_chars(text, text + sizeof(text), value).ptr;
+    game.Answer(std::string_view(text, end - text));
+}
+
+double Seconds(const std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+// Usage: parked_games_bench [games]
+// Suspends every game at its first question, then has a bot answer all of them a year at a
+// time, so that every game is parked and resumed once per question.
+int main(const int argc, char* argv[]) {
+    const std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    const UserInputData policy(0, 0, 1000, 2000);
+    NullSink output;
+    GameIO::SetOutput(&output);
+
+    const std::size_t resident_before = ResidentBytes();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Game> games;
+    games.reserve(count);
+    for (std::uint64_t seed = 0; seed < count; ++seed) {
+        games.emplace_back(GameState(seed));
+        games.back().Begin();
+    }
+    const double park_seconds = Seconds(start);
+    const std::size_t per_game = (ResidentBytes() - resident_before) / count;
+    std::cout << "frame size " << Game::frame_size() << " bytes, about " << per_game << " bytes per parked game, "
+              << static_cast<double>(count) / park_seconds << " games started/s\n";
+
+    std::uint64_t answers = 0;
+    start = std::chrono::steady_clock::now();
+    for (bool playing = true; playing;) {
+        playing = false;
+        for (Game& game : games) {
+            if (game.IsOver()) {
+                continue;
+            }
+            playing = true;
+            const UserInputData decision = game.engine().ClampDecision(policy);
+            game.Answer("n");
+            AnswerNumber(game, decision.acres_to_buy);
+            AnswerNumber(game, decision.acres_to_sell);
+            AnswerNumber(game, decision.wheat_to_plant);
+            AnswerNumber(game, decision.wheat_to_eat);
+            answers += 5;
+        }
+    }
+    const double play_seconds = Seconds(start);
+
+    std::uint64_t mismatches = 0;
+    for (std::uint64_t seed = 0; seed < count; ++seed) {
+        GameEngine engine{GameState(seed)};
+        engine.PlayReign([&](const GameEngine& current) { return current.ClampDecision(policy); });
+        const GameState& expected = engine.game_state();
+        const GameState& actual = games[seed].engine().game_state();
+        mismatches += actual.year_ != expected.year_ || actual.population_ != expected.population_ ||
+                      actual.acres_ != expected.acres_ || actual.wheat_ != expected.wheat_;
+    }
+    std::cout << static_cast<double>(answers) / play_seconds << " answers/s, "
+              << static_cast<double>(count) / play_seconds << " games/s, " << mismatches << " mismatches\n";
+
+    start = std::chrono::steady_clock::now();
+    games.clear();
+    std::cout << static_cast<double>(count) / Seconds(start) << " games destroyed/s\n";
+    GameIO::SetOutput(nullptr);
+    return mismatches == 0 ? 0 : 1;
+}
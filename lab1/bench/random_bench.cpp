@@ -0,0 +1,64 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../src/utils/random.h"
+#include "../src/utils/utils.h"
+
+namespace {
+
+// RandomInRange as it was: a new std::random_device and std::mt19937 per call.
+int LegacyRandomInRange(const int min, const int max) {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<> distrib(min, max);
+
+    return distrib(gen);
+}
+
+template<typename Fn>
+void Measure(const char* name, const std::uint64_t count, Fn&& fn) {
+    std::uint64_t sink = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < count; ++i) {
+        sink += fn();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << static_cast<double>(count) / elapsed.count() << " numbers/s"
+              << " (checksum " << sink << ")\n";
+}
+
+}  // namespace
+
+int main() {
+    constexpr std::uint64_t kCount = 50000000;
+
+    Measure("legacy RandomInRange(1, 6)", kCount / 1000, [] { return LegacyRandomInRange(1, 6); });
+
+    std::mt19937 mt(42);
+    Measure("std::mt19937 + uniform_int_distribution(1, 6)", kCount, [&mt] {
+        return std::uniform_int_distribution<>(1, 6)(mt);
+    });
+
+    Measure("RandomInRange(1, 6)", kCount, [] { return RandomInRange(1, 6); });
+
+    Random random(42);
+    Measure("Random::NextInRange(1, 6)", kCount, [&random] { return random.NextInRange(1, 6); });
+    Measure("Random::Next()", kCount, [&random] { return random.Next(); });
+
+    constexpr std::size_t kBlock = 4096;
+    std::vector<int> block(kBlock);
+    const auto start = std::chrono::steady_clock::now();
+    std::uint64_t sink = 0;
+    for (std::uint64_t i = 0; i < kCount / kBlock; ++i) {
+        random.FillInRange(block.data(), kBlock, 1, 6);
+        sink += block[i % kBlock];
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Random::FillInRange(1, 6): " << static_cast<double>(kCount / kBlock * kBlock) / elapsed.count()
+              << " numbers/s (checksum " << sink << ")\n";
+}
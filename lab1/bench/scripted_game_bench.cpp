@@ -0,0 +1,84 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../src/game/game.h"
+#include "../src/game/game_engine.h"
+#include "../src/game/game_io.h"
+#include "../src/io/input_source.h"
+#include "../src/io/output_sink.h"
+
+namespace {
+
+// A bot that always answers with `policy`, clamped to what the front-end accepts. The answers are
+// worked out on a copy of the engine, so every game must end exactly where `final_states` says.
+std::string MakeScript(const std::uint64_t games, const UserInputData& policy, std::vector<GameState>& final_states) {
+    std::string script;
+    for (std::uint64_t game = 0; game < games; ++game) {
+        GameEngine engine{GameState(game)};
+        engine.GenerateRandomParams();
+        while (!engine.IsGameOver()) {
+            const UserInputData decision = engine.ClampDecision(policy);
+            std::format_to(std::back_inserter(script), "n\n{}\n{}\n{}\n{}\n", decision.acres_to_buy,
+                           decision.acres_to_sell, decision.wheat_to_plant, decision.wheat_to_eat);
+            engine.PlayYear(decision);
+        }
+        final_states.push_back(engine.game_state());
+    }
+    return script;
+}
+
+bool SameState(const GameState& a, const GameState& b) {
+    return a.year_ == b.year_ && a.population_ == b.population_ && a.acres_ == b.acres_ && a.wheat_ == b.wheat_;
+}
+
+// Plays every game through Game, reading the script from `input`; returns the number of games
+// that did not end where the engine said they would.
+std::uint64_t PlayGames(const char* name, InputSource& input, const std::vector<GameState>& final_states) {
+    NullSink output;
+    GameIO::SetInput(&input);
+    GameIO::SetOutput(&output);
+    std::uint64_t mismatches = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::uint64_t game = 0; game < final_states.size(); ++game) {
+        Game session{GameState(game)};
+        session.StartGame();
+        mismatches += !SameState(session.engine().game_state(), final_states[game]);
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    GameIO::SetOutput(nullptr);
+    GameIO::SetInput(nullptr);
+    std::cout << name << ": " << static_cast<double>(final_states.size()) / elapsed.count() << " games/s, "
+              << mismatches << " mismatches\n";
+    return mismatches;
+}
+
+}  // namespace
+
+// Usage: scripted_game_bench [games] [script_path]
+// Bots play complete games through the interactive front-end, from memory and from a file.
+int main(const int argc, char* argv[]) {
+    const std::uint64_t games = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    const std::string path = argc > 2 ? argv[2] : "scripted_game_bench.txt";
+
+    std::vector<GameState> final_states;
+    const std::string script = MakeScript(games, UserInputData(0, 0, 1000, 2000), final_states);
+    std::ofstream(path, std::ios::binary) << script;
+
+    ScriptSource memory(script);
+    FileSource file(path);
+    if (!file.IsOpen()) {
+        std::cerr << "Cannot open " << path << '\n';
+        return 1;
+    }
+    const std::uint64_t mismatches = PlayGames("ScriptSource", memory, final_states) +
+                                     PlayGames("FileSource", file, final_states);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "../src/game/game_engine.h"
+#include "../src/utils/random.h"
+
+namespace {
+
+constexpr double kRations[] = {0.5, 0.6, 0.7, 0.8, 0.9, 1.0};
+constexpr int kScores[] = {0, 1, 2, 3, 4, 5};
+
+// Feeds `share` of what the people need and leaves the land alone.
+UserInputData Ration(const GameEngine& engine, const double share) {
+    const GameState& state = engine.game_state();
+    const int need = std::max(0, state.population_) * engine.rules().wheat_per_person;
+    return engine.ClampDecision({0, 0, 0, static_cast<int>(share * need)});
+}
+
+double Milliseconds(const std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+// Usage: what_if_bench [forks] [year]
+// Plays a game up to `year`, snapshots it and previews a few grain rations for that year: every
+// ration is played out in `forks` copies of the snapshot, each with a future of its own, feeding
+// everyone in the years after. Reports how long forking and the whole preview take.
+int main(const int argc, char* argv[]) {
+    const std::size_t forks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000;
+    const int year = argc > 2 ? std::atoi(argv[2]) : 4;
+
+    GameEngine engine{GameState(42)};
+    engine.GenerateRandomParams();
+    while (engine.game_state().year_ < year && !engine.IsGameOver()) {
+        engine.PlayYear(Ration(engine, 1.0));
+    }
+    const GameSnapshot snapshot = engine.Snapshot();
+
+    // A copy of the snapshot must play exactly like the engine it was taken from.
+    GameEngine original = engine;
+    GameEngine restored(snapshot);
+    original.PlayReign([](const GameEngine& current) { return Ration(current, 0.8); });
+    restored.PlayReign([](const GameEngine& current) { return Ration(current, 0.8); });
+    const GameSnapshot a = original.Snapshot();
+    const GameSnapshot b = restored.Snapshot();
+    if (a.year != b.year || a.population != b.population || a.acres != b.acres || a.wheat != b.wheat ||
+        a.total_starvation_deaths != b.total_starvation_deaths) {
+        std::cerr << "A restored snapshot played differently from the original\n";
+        return 1;
+    }
+
+    std::vector<GameSnapshot> copies(forks);
+    auto start = std::chrono::steady_clock::now();
+    std::fill(copies.begin(), copies.end(), snapshot);
+    const double fork_ms = Milliseconds(start);
+    for (std::size_t i = 0; i < forks; ++i) {
+        copies[i].seed = snapshot.seed ^ SplitMix64(i + 1);
+    }
+
+    std::cout << "Year " << snapshot.year << ": population " << snapshot.population << ", acres " << snapshot.acres
+              << ", wheat " << snapshot.wheat << "; " << forks << " forks of " << sizeof(GameSnapshot)
+              << " bytes in " << fork_ms << " ms\n";
+    start = std::chrono::steady_clock::now();
+    for (const double share : kRations) {
+        int score = 0;
+        int starved = 0;
+        for (const GameSnapshot& copy : copies) {
+            GameEngine fork(copy);
+            fork.PlayYear(Ration(fork, share));
+            while (!fork.IsGameOver()) {
+                fork.PlayYear(Ration(fork, 1.0));
+            }
+            const GameResult result = fork.CalculateResults();
+            score += kScores[static_cast<int>(result)];
+            starved += result == GameResult::kStarvation;
+        }
+        std::cout << "  feed " << share * 100 << "%: mean score " << static_cast<double>(score) / forks
+                  << ", starvation " << 100.0 * starved / forks << "%\n";
+    }
+    std::cout << "Previewed " << std::size(kRations) << " rations in " << Milliseconds(start) << " ms\n";
+    return 0;
+}
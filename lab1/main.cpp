@@ -1,24 +1,40 @@
-#include <iostream>
-
-#include "src/game/Game.h"
+#include "src/game/game.h"
+#include "src/game/game_io.h"
+#include "src/file_system/autosave_journal.h"
+#include "src/file_system/file_manager.h"
+#include "src/leaderboard/leaderboard.h"
+#include "src/replay/replay_log.h"
 
 #ifdef _WIN32
     #include <windows.h>
 #endif
 
-int main() {
+int main(const int argc, char* argv[]) {
 
     #ifdef _WIN32
         SetConsoleOutputCP(CP_UTF8);
     #endif
 
-    Game game;
-    char choice;
-    std::cout << "Хотите загрузить сохраненную игру? (y/n): ";
-    std::cin >> choice;
-    if (choice == 'y') {
-        game.loadGame();
-    } else {
-        game.startGame();
+    if (argc > 1) {
+        FileManager::SetSaveDirectory(argv[1]);
+    }
+
+    // A game cut short by a crash is offered like a saved one. It only takes the place of a game the
+    // player saved if the player says so.
+    AutosaveJournal journal;
+    if (journal.Open(FileManager::SaveDirectory() / "autosave.journal")) {
+        const bool crashed_game = !journal.recovered().empty() && journal.recovered().front().player_id == 0;
+        journal.RestoreSaves(crashed_game && FileManager::IsSaveFileExists() &&
+                             GameIO::AskYesNo("Найдена игра, прерванная сбоем. Заменить ею сохраненную игру? (y/n): "));
     }
+    const bool load = FileManager::IsSaveFileExists() &&
+                      GameIO::AskYesNo("Хотите загрузить сохраненную игру? (y/n): ");
+    ReplayLogWriter replay_log((FileManager::SaveDirectory() / "replay.log").string());
+    // Without the file the board only lasts for this game.
+    Leaderboard leaderboard;
+    leaderboard.Open((FileManager::SaveDirectory() / "leaderboard.dat").string());
+    Game game(load ? FileManager::TryLoadGame() : GameEngine(), &replay_log);
+    game.SetLeaderboard(&leaderboard);
+    game.SetJournal(&journal);
+    game.StartGame();
 }
@@ -0,0 +1,310 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include "autosave_journal.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#include "file_manager.h"
+#include "../utils/crc32.h"
+
+constexpr char kJournalMagic[4] = {'H', 'M', 'J', 'L'};
+constexpr std::uint32_t kJournalVersion = 1;
+
+namespace {
+
+struct FileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t record_size;
+    std::uint32_t reserved;
+};
+
+constexpr std::size_t kReadBatch = 4096;
+
+// CRC-32 of the record with its checksum field zero.
+std::uint32_t Checksum(JournalRecord record) {
+    record.checksum = 0;
+    return Crc32(&record, sizeof(record));
+}
+
+JournalRecord MakeRecord(const std::uint64_t player_id, const JournalRecordKind kind, const UserInputData& decision,
+                         const GameEngine& engine) {
+    JournalRecord record{};
+    record.player_id = player_id;
+    record.kind = kind;
+    record.acres_to_buy = decision.acres_to_buy;
+    record.acres_to_sell = decision.acres_to_sell;
+    record.wheat_to_plant = decision.wheat_to_plant;
+    record.wheat_to_eat = decision.wheat_to_eat;
+    const GameSnapshot snapshot = engine.Snapshot();
+    record.seed = snapshot.seed;
+    record.year = snapshot.year;
+    record.population = snapshot.population;
+    record.acres = snapshot.acres;
+    record.wheat = snapshot.wheat;
+    record.starvation_deaths = snapshot.starvation_deaths;
+    record.new_citizens = snapshot.new_citizens;
+    record.wheat_per_acre = snapshot.wheat_per_acre;
+    record.rats_ate = snapshot.rats_ate;
+    record.land_price = snapshot.land_price;
+    record.total_starvation_deaths = snapshot.total_starvation_deaths;
+    record.plague = snapshot.plague;
+    return record;
+}
+
+GameSnapshot SnapshotOf(const JournalRecord& record) {
+    return {record.seed, record.year, record.population, record.acres, record.wheat, record.starvation_deaths,
+            record.new_citizens, record.wheat_per_acre, record.rats_ate, record.land_price,
+            record.total_starvation_deaths, record.plague};
+}
+
+// Flushes the stream and waits for its data to reach the disk.
+bool SyncFile(std::FILE* file) {
+    if (std::fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return ::fdatasync(::fileno(file)) == 0;
+#endif
+}
+
+void SyncDirectory([[maybe_unused]] const std::filesystem::path& directory) {
+#ifndef _WIN32
+    if (const int dir = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC); dir >= 0) {
+        ::fsync(dir);
+        ::close(dir);
+    }
+#endif
+}
+
+}  // namespace
+
+AutosaveJournal::AutosaveJournal(const std::chrono::microseconds commit_interval)
+    : commit_interval_(commit_interval) {}
+
+AutosaveJournal::~AutosaveJournal() {
+    Stop();
+}
+
+bool AutosaveJournal::Open(const std::filesystem::path& path) {
+    Stop();
+    path_ = path;
+    live_.clear();
+    recovered_.clear();
+    failed_ = false;
+    stopping_ = false;
+
+    std::error_code error;
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path(), error);
+    }
+    if (std::FILE* existing = std::fopen(path.string().c_str(), "rb"); existing != nullptr) {
+        FileHeader header{};
+        const bool valid = std::fread(&header, sizeof(header), 1, existing) == 1 &&
+                           std::memcmp(header.magic, kJournalMagic, sizeof(kJournalMagic)) == 0 &&
+                           header.version == kJournalVersion && header.record_size == sizeof(JournalRecord);
+        std::vector<JournalRecord> batch(kReadBatch);
+        // Records from the first one that fails its checksum on were never committed.
+        bool torn = !valid;
+        while (!torn) {
+            const std::size_t read = std::fread(batch.data(), sizeof(JournalRecord), batch.size(), existing);
+            torn = read == 0;
+            for (std::size_t i = 0; i < read && !torn; ++i) {
+                const JournalRecord& record = batch[i];
+                if (record.checksum != Checksum(record)) {
+                    torn = true;
+                } else if (record.kind == kJournalEnd) {
+                    live_.erase(record.player_id);
+                } else {
+                    live_[record.player_id] = record;
+                }
+            }
+        }
+        std::fclose(existing);
+    }
+    for (const auto& [player_id, record] : live_) {
+        recovered_.push_back({player_id, SnapshotOf(record)});
+    }
+    std::sort(recovered_.begin(), recovered_.end(), [](const RecoveredGame& a, const RecoveredGame& b) {
+        return a.player_id < b.player_id;
+    });
+
+    if (!Compact()) {
+        return false;
+    }
+    open_ = true;
+    writer_ = std::thread(&AutosaveJournal::RunWriter, this);
+    return true;
+}
+
+bool AutosaveJournal::RestoreSaves(const bool replace_single_save) {
+    bool restored = true;
+    std::vector<const RecoveredGame*> player_saves;
+    for (const RecoveredGame& game : recovered_) {
+        const GameEngine engine(game.snapshot);
+        if (game.player_id != 0) {
+            if (FileManager::SaveGame(game.player_id, engine)) {
+                player_saves.push_back(&game);
+            } else {
+                restored = false;
+            }
+        } else if (!replace_single_save && FileManager::IsSaveFileExists()) {
+            RecordEnd(game.player_id, engine);
+        } else if (FileManager::SaveGame(engine)) {
+            RecordEnd(game.player_id, engine);
+        } else {
+            restored = false;
+        }
+    }
+    // Player saves are only safe to end in the journal once they are on disk.
+    if (!player_saves.empty() && !FileManager::FlushPlayerSaves()) {
+        return false;
+    }
+    for (const RecoveredGame* game : player_saves) {
+        RecordEnd(game->player_id, GameEngine(game->snapshot));
+    }
+    return restored;
+}
+
+void AutosaveJournal::RecordStart(const std::uint64_t player_id, const GameEngine& engine) {
+    Append(MakeRecord(player_id, kJournalStart, UserInputData(), engine));
+}
+
+void AutosaveJournal::RecordYear(const std::uint64_t player_id, const UserInputData& decision,
+                                 const GameEngine& engine) {
+    Append(MakeRecord(player_id, kJournalYear, decision, engine));
+}
+
+void AutosaveJournal::RecordEnd(const std::uint64_t player_id, const GameEngine& engine) {
+    Append(MakeRecord(player_id, kJournalEnd, UserInputData(), engine));
+}
+
+void AutosaveJournal::Append(const JournalRecord& record) {
+    const std::lock_guard lock(mutex_);
+    if (!open_) {
+        return;
+    }
+    pending_.push_back(record);
+    ++appended_;
+    // Later records of the batch find the writer already awake.
+    if (pending_.size() == 1) {
+        pending_ready_.notify_one();
+    }
+}
+
+bool AutosaveJournal::Sync() {
+    std::unique_lock lock(mutex_);
+    if (!open_) {
+        return false;
+    }
+    const std::uint64_t target = appended_;
+    ++sync_waiters_;
+    pending_ready_.notify_one();
+    committed_.wait(lock, [this, target] { return committed_count_ >= target || failed_; });
+    --sync_waiters_;
+    return !failed_;
+}
+
+void AutosaveJournal::RunWriter() {
+    std::vector<JournalRecord> batch;
+    std::unique_lock lock(mutex_);
+    while (true) {
+        pending_ready_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+        if (pending_.empty()) {
+            return;
+        }
+        // Let the batch fill up, unless someone is waiting for it.
+        pending_ready_.wait_for(lock, commit_interval_, [this] { return stopping_ || sync_waiters_ > 0; });
+        batch.swap(pending_);
+        const std::uint64_t target = appended_;
+        lock.unlock();
+        const bool written = WriteBatch(batch);
+        batch.clear();
+        lock.lock();
+        committed_count_ = target;
+        failed_ = failed_ || !written;
+        committed_.notify_all();
+    }
+}
+
+bool AutosaveJournal::WriteBatch(std::vector<JournalRecord>& batch) {
+    // A failed compaction leaves no file to write to.
+    if (file_ == nullptr) {
+        return false;
+    }
+    for (JournalRecord& record : batch) {
+        record.checksum = Checksum(record);
+        if (record.kind == kJournalEnd) {
+            live_.erase(record.player_id);
+        } else {
+            live_[record.player_id] = record;
+        }
+    }
+    const bool written = std::fwrite(batch.data(), sizeof(JournalRecord), batch.size(), file_) == batch.size() &&
+                         SyncFile(file_);
+    file_bytes_ += batch.size() * sizeof(JournalRecord);
+    return written && (file_bytes_ < kCompactBytes || Compact());
+}
+
+bool AutosaveJournal::Compact() {
+    if (file_ != nullptr) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+    std::filesystem::path temporary = path_;
+    temporary += ".tmp";
+    std::FILE* file = std::fopen(temporary.string().c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    FileHeader header{};
+    std::memcpy(header.magic, kJournalMagic, sizeof(kJournalMagic));
+    header.version = kJournalVersion;
+    header.record_size = sizeof(JournalRecord);
+    bool written = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    for (const auto& [player_id, record] : live_) {
+        written = written && std::fwrite(&record, sizeof(record), 1, file) == 1;
+    }
+    written = SyncFile(file) && written;
+    written = std::fclose(file) == 0 && written;
+    std::error_code error;
+    // The old journal stays whole until the rename replaces it.
+    if (written) {
+        std::filesystem::rename(temporary, path_, error);
+    }
+    if (!written || error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    SyncDirectory(path_.has_parent_path() ? path_.parent_path() : std::filesystem::path("."));
+
+    file_ = std::fopen(path_.string().c_str(), "ab");
+    file_bytes_ = sizeof(header) + live_.size() * sizeof(JournalRecord);
+    return file_ != nullptr;
+}
+
+void AutosaveJournal::Stop() {
+    if (writer_.joinable()) {
+        {
+            const std::lock_guard lock(mutex_);
+            stopping_ = true;
+            open_ = false;
+        }
+        pending_ready_.notify_one();
+        writer_.join();
+    }
+    if (file_ != nullptr) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
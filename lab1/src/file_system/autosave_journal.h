@@ -0,0 +1,132 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "../game/game_engine.h"
+
+// One journal entry, written to the file as one block in host byte order. It has no padding, so
+// its checksum covers every byte of it however it is copied.
+struct JournalRecord {
+    std::uint64_t player_id;
+    // A JournalRecordKind.
+    std::uint32_t kind;
+    // CRC-32 of the record with this field zero; a record torn by a crash fails it.
+    std::uint32_t checksum;
+    // The decision of the year just played; zero for the other kinds.
+    std::int32_t acres_to_buy;
+    std::int32_t acres_to_sell;
+    std::int32_t wheat_to_plant;
+    std::int32_t wheat_to_eat;
+    // The game after the record's event, field by field as in GameSnapshot.
+    std::uint64_t seed;
+    std::int32_t year;
+    std::int32_t population;
+    std::int32_t acres;
+    std::int32_t wheat;
+    std::int32_t starvation_deaths;
+    std::int32_t new_citizens;
+    std::int32_t wheat_per_acre;
+    std::int32_t rats_ate;
+    std::int32_t land_price;
+    std::int32_t total_starvation_deaths;
+    std::int32_t plague;
+    std::int32_t reserved[3];
+};
+
+static_assert(sizeof(JournalRecord) == 96 && std::has_unique_object_representations_v<JournalRecord>,
+              "JournalRecord layout is part of the journal format");
+
+enum JournalRecordKind : std::uint32_t {
+    // A game has started or been loaded.
+    kJournalStart = 1,
+    kJournalYear = 2,
+    // The reign is over; nothing to recover.
+    kJournalEnd = 3,
+};
+
+// A game the journal held when it was opened: the player's game as of its last recorded year.
+struct RecoveredGame {
+    std::uint64_t player_id;
+    GameSnapshot snapshot;
+};
+
+// Write-ahead autosave. Every game start and every year played is appended to the journal as a
+// fixed-size record, so after a crash each player's game can be picked up from its last year
+// whether or not it was saved. Recording only copies the record into a buffer; a background
+// thread writes whatever has piled up and syncs it with one fdatasync (group commit), at most
+// commit_interval after the first record of the batch. A crash loses the records of that window
+// at most, less than a turn of any human player.
+//
+// Opening the journal drops a torn record at its end, keeps the last record of every game that
+// did not end and rewrites the file with just those; the writer does the same whenever the file
+// grows past kCompactBytes. Records may come from any thread.
+class AutosaveJournal {
+ public:
+    static constexpr std::chrono::microseconds kDefaultCommitInterval{2000};
+    static constexpr std::uint64_t kCompactBytes = std::uint64_t{16} << 20;
+
+    explicit AutosaveJournal(std::chrono::microseconds commit_interval = kDefaultCommitInterval);
+    // Commits what is pending.
+    ~AutosaveJournal();
+    AutosaveJournal(const AutosaveJournal&) = delete;
+    AutosaveJournal& operator=(const AutosaveJournal&) = delete;
+
+    // Opens or creates the journal and recovers the games left in it; false if it cannot be written.
+    bool Open(const std::filesystem::path& path);
+    [[nodiscard]] bool IsOpen() const { return open_; }
+    // Games that had not ended when the journal was last written, as found by Open(), by player id.
+    [[nodiscard]] const std::vector<RecoveredGame>& recovered() const { return recovered_; }
+    // Writes every recovered game to its player's save (player 0 to the single save file), so that
+    // it is offered for loading like any other save, and records its end so that it is restored
+    // once only. A game of player 0 replaces a single save file that exists only if
+    // `replace_single_save`, and is dropped otherwise. False if a save fails.
+    bool RestoreSaves(bool replace_single_save = false);
+
+    void RecordStart(std::uint64_t player_id, const GameEngine& engine);
+    void RecordYear(std::uint64_t player_id, const UserInputData& decision, const GameEngine& engine);
+    void RecordEnd(std::uint64_t player_id, const GameEngine& engine);
+    // Waits until everything recorded so far is on disk; false if writing has failed.
+    bool Sync();
+
+ private:
+    void Append(const JournalRecord& record);
+    void RunWriter();
+    bool WriteBatch(std::vector<JournalRecord>& batch);
+    // Rewrites the file with the live records only.
+    bool Compact();
+    void Stop();
+
+    std::chrono::microseconds commit_interval_;
+    std::filesystem::path path_;
+    // The file and live_ belong to the writer thread while it runs.
+    std::FILE* file_ = nullptr;
+    std::uint64_t file_bytes_ = 0;
+    std::vector<RecoveredGame> recovered_;
+    // The last record of every game that has not ended.
+    std::unordered_map<std::uint64_t, JournalRecord> live_;
+
+    std::mutex mutex_;
+    std::condition_variable pending_ready_;
+    std::condition_variable committed_;
+    std::vector<JournalRecord> pending_;
+    // Records appended and records on disk so far.
+    std::uint64_t appended_ = 0;
+    std::uint64_t committed_count_ = 0;
+    int sync_waiters_ = 0;
+    bool open_ = false;
+    bool failed_ = false;
+    bool stopping_ = false;
+    std::thread writer_;
+};
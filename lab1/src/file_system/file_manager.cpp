@@ -3,26 +3,141 @@
 //
 
 #include "file_manager.h"
+#include "save_record.h"
+#include "save_store.h"
 
-#include <iostream>
 #include <fstream>
 
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+constexpr char kSaveFileName[] = "savegame.bin";
+constexpr char kSaveStoreFileName[] = "saves.slots";
+
+std::filesystem::path FileManager::save_directory_ = "../save";
+std::unique_ptr<SaveStore> FileManager::store_owner_;
+std::atomic<SaveStore*> FileManager::store_{nullptr};
+std::mutex FileManager::store_mutex_;
+
+namespace {
+
+bool WriteFileDurably(const std::filesystem::path& path, const void* data, const std::size_t size) {
+#ifdef _WIN32
+    if (std::ofstream file(path, std::ios::binary | std::ios::trunc); file.is_open()) {
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        file.flush();
+        return file.good();
+    }
+    return false;
+#else
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    const auto* bytes = static_cast<const char*>(data);
+    std::size_t written = 0;
+    while (written < size) {
+        const ssize_t result = ::write(fd, bytes + written, size - written);
+        if (result <= 0) {
+            ::close(fd);
+            return false;
+        }
+        written += static_cast<std::size_t>(result);
+    }
+    const bool synced = ::fsync(fd) == 0;
+    return ::close(fd) == 0 && synced;
+#endif
+}
+
+bool ReplaceFile(const std::filesystem::path& from, const std::filesystem::path& to) {
+#ifdef _WIN32
+    return MoveFileExW(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    if (::rename(from.c_str(), to.c_str()) != 0) {
+        return false;
+    }
+    // Persist the directory entry as well, otherwise the rename itself may be lost.
+    if (const int dir = ::open(to.parent_path().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC); dir >= 0) {
+        ::fsync(dir);
+        ::close(dir);
+    }
+    return true;
+#endif
+}
+
+}  // namespace
+
+void FileManager::SetSaveDirectory(const std::filesystem::path& directory) {
+    const std::lock_guard lock(store_mutex_);
+    save_directory_ = directory;
+    store_.store(nullptr, std::memory_order_release);
+    store_owner_.reset();
+}
+
+const std::filesystem::path& FileManager::SaveDirectory() {
+    return save_directory_;
+}
+
 bool FileManager::IsSaveFileExists() {
-    return std::ifstream("../save/savegame.txt").good();
+    std::error_code error;
+    return std::filesystem::file_size(save_directory_ / kSaveFileName, error) == sizeof(SaveRecord);
+}
+
+GameEngine FileManager::TryLoadGame() {
+    SaveRecord record{};
+    if (std::ifstream saveFile(save_directory_ / kSaveFileName, std::ios::binary); saveFile.is_open()) {
+        saveFile.read(reinterpret_cast<char*>(&record), sizeof(record));
+    }
+    GameEngine engine;
+    ReadSaveRecord(record, engine);
+    return engine;
 }
 
-GameState FileManager::TryLoadGame() {
-    GameState gameState;
-    if (std::ifstream saveFile("../save/savegame.txt"); saveFile.is_open()) {
-        saveFile >> gameState.year_ >> gameState.population_ >> gameState.acres_ >> gameState.wheat_;
-        saveFile.close();
+bool FileManager::SaveGame(const GameEngine& engine) {
+    const SaveRecord record = MakeSaveRecord(engine);
+
+    std::error_code error;
+    std::filesystem::create_directories(save_directory_, error);
+    const std::filesystem::path path = save_directory_ / kSaveFileName;
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    if (!WriteFileDurably(temporary, &record, sizeof(record)) || !ReplaceFile(temporary, path)) {
+        std::filesystem::remove(temporary, error);
+        return false;
     }
-    return gameState;
+    return true;
 }
 
-void FileManager::SaveGame(const GameState& gameState) {
-    if (std::ofstream saveFile("../../save/savegame.txt"); saveFile.is_open()) {
-        saveFile << gameState.year_ << " " << gameState.population_ << " " << gameState.acres_ << " " << gameState.wheat_ << std::endl;
-        saveFile.close();
+SaveStore& FileManager::Store() {
+    if (SaveStore* store = store_.load(std::memory_order_acquire)) {
+        return *store;
     }
+    const std::lock_guard lock(store_mutex_);
+    if (!store_owner_) {
+        store_owner_ = std::make_unique<SaveStore>(save_directory_ / kSaveStoreFileName);
+        store_.store(store_owner_.get(), std::memory_order_release);
+    }
+    return *store_owner_;
+}
+
+bool FileManager::IsSaveFileExists(const std::uint64_t player_id) {
+    return Store().Contains(player_id);
+}
+
+GameEngine FileManager::TryLoadGame(const std::uint64_t player_id) {
+    GameEngine engine;
+    Store().Load(player_id, engine);
+    return engine;
+}
+
+bool FileManager::SaveGame(const std::uint64_t player_id, const GameEngine& engine) {
+    return Store().Save(player_id, engine);
+}
+
+bool FileManager::FlushPlayerSaves() {
+    return Store().Flush();
 }
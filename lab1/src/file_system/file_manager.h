@@ -3,11 +3,42 @@
 //
 
 #pragma once
-#include "../game/game_state.h" //fixme todo
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+
+#include "../game/game_engine.h"
+#include "../game_state/game_state.h"
+
+class SaveStore;
 
 class FileManager {
  public:
+    // Must not race with saves or loads in progress.
+    static void SetSaveDirectory(const std::filesystem::path& directory);
+    static const std::filesystem::path& SaveDirectory();
+
     static bool IsSaveFileExists();
-    static GameState TryLoadGame();
-    static void SaveGame(const GameState& gameState);
+    // Returns a fresh game if there is no save or it fails the header or checksum check.
+    static GameEngine TryLoadGame();
+    // Replaces the save atomically: the old save survives any crash before the rename.
+    static bool SaveGame(const GameEngine& engine);
+
+    // Per-player saves in the shared slot store of the save directory.
+    static bool IsSaveFileExists(std::uint64_t player_id);
+    static GameEngine TryLoadGame(std::uint64_t player_id);
+    static bool SaveGame(std::uint64_t player_id, const GameEngine& engine);
+    // Player saves only reach the page cache; this makes them durable.
+    static bool FlushPlayerSaves();
+
+ private:
+    static SaveStore& Store();
+
+    static std::filesystem::path save_directory_;
+    static std::unique_ptr<SaveStore> store_owner_;
+    static std::atomic<SaveStore*> store_;
+    static std::mutex store_mutex_;
 };
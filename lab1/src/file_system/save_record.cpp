@@ -0,0 +1,65 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include "save_record.h"
+
+#include <cstddef>
+#include <cstring>
+
+#include "../utils/crc32.h"
+
+constexpr char kSaveMagic[4] = {'H', 'M', 'S', 'V'};
+constexpr std::uint16_t kSaveVersion = 1;
+
+namespace {
+
+constexpr std::size_t kChecksumOffset = offsetof(SaveRecord, year);
+
+// CRC-32 of everything after the header.
+std::uint32_t Checksum(const SaveRecord& record) {
+    return Crc32(reinterpret_cast<const unsigned char*>(&record) + kChecksumOffset,
+                 sizeof(SaveRecord) - kChecksumOffset);
+}
+
+}  // namespace
+
+SaveRecord MakeSaveRecord(const GameEngine& engine) {
+    const GameState& gameState = engine.game_state();
+    const YearState yearState = engine.year_state();
+
+    SaveRecord record{};
+    std::memcpy(record.magic, kSaveMagic, sizeof(kSaveMagic));
+    record.version = kSaveVersion;
+    record.size = sizeof(SaveRecord);
+    record.year = gameState.year_;
+    record.population = gameState.population_;
+    record.acres = gameState.acres_;
+    record.wheat = gameState.wheat_;
+    record.seed = gameState.seed_;
+    record.starvation_deaths = yearState.starvation_deaths;
+    record.new_citizens = yearState.new_citizens;
+    record.plague = yearState.plague ? 1 : 0;
+    record.wheat_per_acre = yearState.wheat_per_acre;
+    record.rats_ate = yearState.rats_ate;
+    record.land_price = yearState.land_price;
+    record.total_starvation_deaths = yearState.total_starvation_deaths;
+    record.checksum = Checksum(record);
+    return record;
+}
+
+bool ReadSaveRecord(const SaveRecord& record, GameEngine& engine) {
+    if (std::memcmp(record.magic, kSaveMagic, sizeof(kSaveMagic)) != 0 || record.version != kSaveVersion ||
+        record.size != sizeof(SaveRecord) || record.checksum != Checksum(record)) {
+        return false;
+    }
+
+    GameState gameState(record.seed);
+    gameState.year_ = record.year;
+    gameState.population_ = record.population;
+    gameState.acres_ = record.acres;
+    gameState.wheat_ = record.wheat;
+    const YearState yearState{record.starvation_deaths, record.new_citizens, record.plague != 0,
+                              record.wheat_per_acre, record.rats_ate, record.land_price,
+                              record.total_starvation_deaths};
+    engine = GameEngine(gameState, yearState);
+    return true;
+}
@@ -0,0 +1,33 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#pragma once
+
+#include <cstdint>
+
+#include "../game/game_engine.h"
+
+// On-disk save of one game, written and read as one block in host byte order.
+struct SaveRecord {
+    char magic[4];
+    std::uint16_t version;
+    std::uint16_t size;
+    std::uint32_t checksum;
+    std::int32_t year;
+    std::uint64_t seed;
+    std::int32_t population;
+    std::int32_t acres;
+    std::int32_t wheat;
+    std::int32_t starvation_deaths;
+    std::int32_t new_citizens;
+    std::int32_t plague;
+    std::int32_t wheat_per_acre;
+    std::int32_t rats_ate;
+    std::int32_t land_price;
+    std::int32_t total_starvation_deaths;
+};
+
+static_assert(sizeof(SaveRecord) == 64, "SaveRecord layout is part of the save format");
+
+SaveRecord MakeSaveRecord(const GameEngine& engine);
+// False if the record fails the header or checksum check.
+bool ReadSaveRecord(const SaveRecord& record, GameEngine& engine);
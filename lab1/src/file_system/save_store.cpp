@@ -0,0 +1,263 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include "save_store.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "../utils/random.h"
+
+constexpr char kStoreMagic[4] = {'H', 'M', 'S', 'S'};
+constexpr std::uint32_t kStoreVersion = 1;
+constexpr std::size_t kRecordWords = sizeof(SaveRecord) / sizeof(std::uint64_t);
+
+struct SaveStore::Header {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t slot_count;
+    std::uint32_t slot_size;
+    unsigned char reserved[48];
+};
+
+struct alignas(64) SaveStore::Slot {
+    // 0 while the slot is free; set once and never cleared.
+    std::uint64_t player_id;
+    // Odd while a writer is copying the record in.
+    std::uint64_t sequence;
+    unsigned char reserved[48];
+    std::uint64_t record[kRecordWords];
+};
+
+static_assert(sizeof(SaveRecord) % sizeof(std::uint64_t) == 0);
+
+namespace {
+
+using AtomicWord = std::atomic_ref<std::uint64_t>;
+
+std::uint64_t LoadWord(std::uint64_t& word, const std::memory_order order) {
+    return AtomicWord(word).load(order);
+}
+
+}  // namespace
+
+SaveStore::SaveStore(const std::filesystem::path& path, std::uint32_t slot_count)
+    : mapping_(nullptr), mapping_size_(0), slots_(nullptr), slot_count_(0) {
+#ifdef _WIN32
+    file_handle_ = INVALID_HANDLE_VALUE;
+    mapping_handle_ = nullptr;
+#else
+    fd_ = -1;
+#endif
+    slot_count = std::bit_ceil(std::max<std::uint32_t>(slot_count, 1));
+    std::size_t file_size = sizeof(Header) + static_cast<std::size_t>(slot_count) * sizeof(Slot);
+
+    std::error_code error;
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path(), error);
+    }
+    const bool exists = std::filesystem::exists(path, error);
+    if (exists) {
+        // An existing store keeps the slot count it was created with.
+        Header header{};
+        if (std::FILE* file = std::fopen(path.string().c_str(), "rb")) {
+            if (std::fread(&header, sizeof(header), 1, file) != 1) {
+                header = Header{};
+            }
+            std::fclose(file);
+        }
+        if (std::memcmp(header.magic, kStoreMagic, sizeof(kStoreMagic)) != 0 || header.version != kStoreVersion ||
+            header.slot_size != sizeof(Slot) || !std::has_single_bit(header.slot_count)) {
+            return;
+        }
+        slot_count = header.slot_count;
+        file_size = sizeof(Header) + static_cast<std::size_t>(slot_count) * sizeof(Slot);
+        if (std::filesystem::file_size(path, error) < file_size) {
+            return;
+        }
+    }
+
+#ifdef _WIN32
+    file_handle_ = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                               nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle_ == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    mapping_handle_ = CreateFileMappingW(file_handle_, nullptr, PAGE_READWRITE,
+                                         static_cast<DWORD>(static_cast<std::uint64_t>(file_size) >> 32),
+                                         static_cast<DWORD>(file_size), nullptr);
+    if (mapping_handle_ == nullptr) {
+        return;
+    }
+    mapping_ = MapViewOfFile(mapping_handle_, FILE_MAP_ALL_ACCESS, 0, 0, file_size);
+#else
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        return;
+    }
+    // A new file is extended sparsely, so untouched slots cost no disk space.
+    if (!exists && ::ftruncate(fd_, static_cast<off_t>(file_size)) != 0) {
+        return;
+    }
+    void* mapping = ::mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    mapping_ = mapping == MAP_FAILED ? nullptr : mapping;
+#endif
+    if (mapping_ == nullptr) {
+        return;
+    }
+    mapping_size_ = file_size;
+
+    auto* header = static_cast<Header*>(mapping_);
+    if (!exists) {
+        header->version = kStoreVersion;
+        header->slot_count = slot_count;
+        header->slot_size = sizeof(Slot);
+        std::memcpy(header->magic, kStoreMagic, sizeof(kStoreMagic));
+    }
+    slots_ = reinterpret_cast<Slot*>(header + 1);
+    slot_count_ = slot_count;
+    if (exists) {
+        // A process that died mid-save leaves its slot's counter odd, which would stall every reader
+        // and writer of the slot; the record's checksum already rejects what it left half written.
+        for (std::uint32_t i = 0; i < slot_count_; ++i) {
+            if (slots_[i].sequence & 1) {
+                ++slots_[i].sequence;
+            }
+        }
+    }
+}
+
+SaveStore::~SaveStore() {
+#ifdef _WIN32
+    if (mapping_ != nullptr) {
+        UnmapViewOfFile(mapping_);
+    }
+    if (mapping_handle_ != nullptr) {
+        CloseHandle(mapping_handle_);
+    }
+    if (file_handle_ != INVALID_HANDLE_VALUE) {
+        CloseHandle(file_handle_);
+    }
+#else
+    if (mapping_ != nullptr) {
+        ::munmap(mapping_, mapping_size_);
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+#endif
+}
+
+bool SaveStore::IsOpen() const {
+    return slots_ != nullptr;
+}
+
+SaveStore::Slot* SaveStore::Find(const std::uint64_t player_id) const {
+    if (slots_ == nullptr || player_id == 0) {
+        return nullptr;
+    }
+    const std::uint32_t mask = slot_count_ - 1;
+    std::uint32_t index = static_cast<std::uint32_t>(SplitMix64(player_id)) & mask;
+    for (std::uint32_t probe = 0; probe < slot_count_; ++probe, index = (index + 1) & mask) {
+        const std::uint64_t id = LoadWord(slots_[index].player_id, std::memory_order_acquire);
+        if (id == player_id) {
+            return &slots_[index];
+        }
+        if (id == 0) {
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+SaveStore::Slot* SaveStore::FindOrClaim(const std::uint64_t player_id) {
+    if (slots_ == nullptr || player_id == 0) {
+        return nullptr;
+    }
+    const std::uint32_t mask = slot_count_ - 1;
+    std::uint32_t index = static_cast<std::uint32_t>(SplitMix64(player_id)) & mask;
+    for (std::uint32_t probe = 0; probe < slot_count_; ++probe, index = (index + 1) & mask) {
+        std::uint64_t id = LoadWord(slots_[index].player_id, std::memory_order_acquire);
+        if (id == 0 && AtomicWord(slots_[index].player_id).compare_exchange_strong(id, player_id,
+                                                                                    std::memory_order_acq_rel)) {
+            return &slots_[index];
+        }
+        if (id == player_id) {
+            return &slots_[index];
+        }
+    }
+    return nullptr;
+}
+
+bool SaveStore::Contains(const std::uint64_t player_id) const {
+    GameEngine engine;
+    return Load(player_id, engine);
+}
+
+bool SaveStore::Load(const std::uint64_t player_id, GameEngine& engine) const {
+    Slot* slot = Find(player_id);
+    if (slot == nullptr) {
+        return false;
+    }
+    SaveRecord record;
+    std::uint64_t words[kRecordWords];
+    while (true) {
+        const std::uint64_t before = LoadWord(slot->sequence, std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        for (std::size_t i = 0; i < kRecordWords; ++i) {
+            words[i] = LoadWord(slot->record[i], std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (LoadWord(slot->sequence, std::memory_order_relaxed) == before) {
+            break;
+        }
+    }
+    std::memcpy(&record, words, sizeof(record));
+    return ReadSaveRecord(record, engine);
+}
+
+bool SaveStore::Save(const std::uint64_t player_id, const GameEngine& engine) {
+    Slot* slot = FindOrClaim(player_id);
+    if (slot == nullptr) {
+        return false;
+    }
+    const SaveRecord record = MakeSaveRecord(engine);
+    std::uint64_t words[kRecordWords];
+    std::memcpy(words, &record, sizeof(record));
+
+    AtomicWord sequence(slot->sequence);
+    std::uint64_t current = sequence.load(std::memory_order_relaxed);
+    while ((current & 1) || !sequence.compare_exchange_weak(current, current + 1, std::memory_order_acquire)) {
+        current &= ~std::uint64_t{1};
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    for (std::size_t i = 0; i < kRecordWords; ++i) {
+        AtomicWord(slot->record[i]).store(words[i], std::memory_order_relaxed);
+    }
+    sequence.store(current + 2, std::memory_order_release);
+    return true;
+}
+
+bool SaveStore::Flush() {
+    if (mapping_ == nullptr) {
+        return false;
+    }
+#ifdef _WIN32
+    return FlushViewOfFile(mapping_, mapping_size_) != 0 && FlushFileBuffers(file_handle_) != 0;
+#else
+    return ::msync(mapping_, mapping_size_, MS_SYNC) == 0;
+#endif
+}
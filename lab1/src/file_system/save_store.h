@@ -0,0 +1,60 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+#include "save_record.h"
+#include "../game/game_engine.h"
+
+// Many named saves in one memory-mapped file. The file is a header followed by
+// a fixed power-of-two table of slots, addressed by open addressing on the
+// player id, so a lookup touches one or two cache lines. Readers never lock:
+// every slot is guarded by a sequence counter and a reader simply retries if a
+// writer was active while it copied. Writers to one slot exclude each other by
+// taking the counter from even to odd. Opening the store evens out a counter
+// left odd by a crashed writer.
+//
+// Saves land in the page cache only; call Flush() to make them durable.
+class SaveStore {
+ public:
+    static constexpr std::uint32_t kDefaultSlotCount = 1 << 16;
+
+    // Opens the store at `path`, creating it with `slot_count` slots (rounded up
+    // to a power of two) if it does not exist yet.
+    explicit SaveStore(const std::filesystem::path& path, std::uint32_t slot_count = kDefaultSlotCount);
+    ~SaveStore();
+
+    SaveStore(const SaveStore&) = delete;
+    SaveStore& operator=(const SaveStore&) = delete;
+
+    [[nodiscard]] bool IsOpen() const;
+    [[nodiscard]] std::uint32_t slot_count() const { return slot_count_; }
+
+    [[nodiscard]] bool Contains(std::uint64_t player_id) const;
+    // Player id 0 is reserved. Returns false if the player has no valid save.
+    bool Load(std::uint64_t player_id, GameEngine& engine) const;
+    // Returns false if the table is full.
+    bool Save(std::uint64_t player_id, const GameEngine& engine);
+    bool Flush();
+
+ private:
+    struct Header;
+    struct Slot;
+
+    [[nodiscard]] Slot* Find(std::uint64_t player_id) const;
+    Slot* FindOrClaim(std::uint64_t player_id);
+
+    void* mapping_;
+    std::size_t mapping_size_;
+    Slot* slots_;
+    std::uint32_t slot_count_;
+#ifdef _WIN32
+    void* file_handle_;
+    void* mapping_handle_;
+#else
+    int fd_;
+#endif
+};
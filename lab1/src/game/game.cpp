@@ -1,144 +1,260 @@
 // Copyright 2024 Sergo Elizbarashvili
 
-#include <format>
-#include <fstream>
-#include <iostream>
+#include "game.h"
+
 #include <algorithm>
-#include "Game.h"
-#include "Utils.h"
-#include "../file_system/file_manager.h" //fixme todo
+#include <atomic>
+#include <exception>
+#include <utility>
 
-constexpr int kWheatPerPerson = 20;
-constexpr int kMaxYears = 10;
-constexpr double kMaxStarvationDeaths = 0.45;
-constexpr double kRatsWheatConsumptionFraction = 0.07;
+#include "game_io.h"
+#include "../file_system/autosave_journal.h"
+#include "../file_system/file_manager.h"
+#include "../leaderboard/leaderboard.h"
+#include "../replay/replay_log.h"
+#include "../utils/frame_pool.h"
 
-Game::Game(const GameState& game_state): starvation_deaths_(0), new_citizens_(0),
-              plague_(false), wheat_per_acre_(0), rats_ate_(0), land_price_(0),
-              total_starvation_deaths_(0), game_state_(game_state) {
-}
+namespace {
 
-Game::Game(): Game(GameState()) {}
+std::atomic<std::size_t> game_frame_size{0};
 
-void Game::StartGame() {
-    GenerateRandomParams();
-    while (!IsGameOver()) {
-        AskSaveAndExit();
-        UserInput();
-        NextYear();
-    }
+bool SaveGame(const std::uint64_t player_id, const GameEngine& engine) {
+    return player_id != 0 ? FileManager::SaveGame(player_id, engine) : FileManager::SaveGame(engine);
 }
 
-void Game::AskSaveAndExit() const {
-    std::cout << "Желаете сохранить игру и выйти? (y/n): ";
-    char choice;
-    std::cin >> choice;
-    if (choice == 'y') {
-        FileManager::SaveGame(game_state_);
+}  // namespace
+
+struct Game::Promise {
+    // What the suspended game is waiting for.
+    enum class Question : std::uint8_t { kNone, kYesNo, kNumber };
+
+    GameEngine engine;
+    ReplayLogWriter* replay_log;
+    Leaderboard* leaderboard = nullptr;
+    AutosaveJournal* journal = nullptr;
+    // 0 saves to the single save file, anything else to that player's slot.
+    std::uint64_t player_id = 0;
+    // A number is accepted up to `accepted`; the prompt shows `shown`.
+    int shown = 0;
+    int accepted = 0;
+    int answer = 0;
+    Question question = Question::kNone;
+
+    Promise(const GameEngine& engine, ReplayLogWriter* replay_log): engine(engine), replay_log(replay_log) {}
+
+    static void* operator new(const std::size_t size) {
+        game_frame_size.store(size, std::memory_order_relaxed);
+        return FramePool::Allocate(size);
+    }
+    static void operator delete(void* frame, const std::size_t size) {
+        FramePool::Deallocate(frame, size);
     }
-}
 
-void Game::NextYear() {
-    game_state_.year_++;
+    Turns get_return_object() { return {Handle::from_promise(*this)}; }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+};
 
-    const int totalWheat = game_state_.acres_ * wheat_per_acre_ - rats_ate_;
-    game_state_.wheat_ += totalWheat;
+// Gives the coroutine body its own promise without suspending.
+struct Game::Self {
+    Promise* promise = nullptr;
 
-    if (plague_) {
-        game_state_.population_ /= 2;
+    bool await_ready() const { return false; }
+    bool await_suspend(const Handle handle) {
+        promise = &handle.promise();
+        return false;
     }
+    Promise& await_resume() const { return *promise; }
+};
 
-    game_state_.population_ -= starvation_deaths_;
+struct Game::AskSaveAndExit {
+    Promise& promise;
 
-    total_starvation_deaths_ += starvation_deaths_;
-    new_citizens_ = (starvation_deaths_ / 2 + (5 - wheat_per_acre_) * totalWheat / 600 + 1);
-    new_citizens_ = std::max(0, std::min(50, new_citizens_));
+    bool await_ready() const { return false; }
+    void await_suspend(Handle) const {
+        GameIO::PromptSaveAndExit();
+        promise.question = Promise::Question::kYesNo;
+    }
+    bool await_resume() const { return promise.answer != 0; }
+};
 
-    game_state_.population_ += new_citizens_;
+struct Game::AskNumber {
+    Promise& promise;
+    int shown;
+    int accepted;
 
-    if (IsGameOver()) {
-        CalculateResults();
-    } else {
-        GenerateRandomParams();
-        PrintStatus();
+    bool await_ready() const { return false; }
+    void await_suspend(Handle) const {
+        GameIO::PromptNumber(shown);
+        promise.shown = shown;
+        promise.accepted = accepted;
+        promise.question = Promise::Question::kNumber;
     }
+    int await_resume() const { return promise.answer; }
+};
+
+Game::Game(const GameEngine& engine, ReplayLogWriter* replay_log): handle_(Play(engine, replay_log).handle) {
 }
 
-bool Game::IsGameOver() const {
-    return starvation_deaths_ > kMaxStarvationDeaths * game_state_.population_ ||
-        game_state_.population_ == 0 || game_state_.year_ >= kMaxYears;
+Game::Game(const GameState& game_state, ReplayLogWriter* replay_log): Game(GameEngine(game_state), replay_log) {
 }
 
+Game::Game(const GameSnapshot& snapshot, ReplayLogWriter* replay_log): Game(GameEngine(snapshot), replay_log) {
+}
+
+Game::Game(): Game(GameState()) {}
+
+Game::Game(Game&& other) noexcept: handle_(std::exchange(other.handle_, nullptr)) {}
 
-void Game::GenerateRandomParams() {
-    plague_ = RandomInRange(0, 100) < 15;
-    wheat_per_acre_ = RandomInRange(1, 6);
-    rats_ate_ = RandomInRange(0, static_cast<int>(game_state_.wheat_ * kRatsWheatConsumptionFraction));
-    land_price_ = RandomInRange(17, 26);
+Game& Game::operator=(Game&& other) noexcept {
+    if (this != &other) {
+        if (handle_) {
+            handle_.destroy();
+        }
+        handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
 }
 
-void Game::UpdateCityState(const int acres_to_buy, const int acres_to_sell,
-                           const int wheat_to_plant, const int wheat_to_eat) {
-    game_state_.acres_ += acres_to_buy - acres_to_sell;
-    game_state_.wheat_ -= wheat_to_eat + wheat_to_plant;
-    game_state_.wheat_ += acres_to_sell * wheat_per_acre_;
-    starvation_deaths_ = std::max(0, game_state_.population_ - wheat_to_eat / kWheatPerPerson);
+Game::~Game() {
+    if (handle_) {
+        handle_.destroy();
+    }
 }
 
-void Game::UserInput() {
-    std::cout << "Что пожелаешь, повелитель? ";
-    std::cout << "Сколько акров земли повелеваешь купить?\n";
-    const int max_acres_to_buy = game_state_.wheat_ / land_price_;
-    const int acres_to_buy = ValidateInput(0, max_acres_to_buy, "Введите число от 0 до " + std::to_string(max_acres_to_buy) + ": ");
-    std::cout << "Сколько акров земли повелеваешь продать?\n";
-    const int acres_to_sell = ValidateInput(0, game_state_.acres_, "Введите число от 0 до " + std::to_string(game_state_.acres_) + ": ");
-    std::cout << "Сколько акров земли повелеваешь засеять?\n";
-    const int max_wheat_to_plant = std::min(game_state_.wheat_, game_state_.acres_);
-    const int wheat_to_plant = ValidateInput(0, std::max(game_state_.wheat_, max_wheat_to_plant), "Введите число от 0 до " + std::to_string(max_wheat_to_plant) + ": ");
-    std::cout << "Сколько бушелей пшеницы повелеваешь съесть?\n";
-    const int wheat_remaining = game_state_.wheat_ - acres_to_buy * land_price_ + acres_to_sell * land_price_ - wheat_to_plant;
-    const int wheat_to_eat = ValidateInput(0, wheat_remaining, "Введите число от 0 до " + std::to_string(wheat_remaining) + ": ");
+Game::Turns Game::Play(const GameEngine&, ReplayLogWriter*) {
+    Promise& game = co_await Self{};
+    GameEngine& engine = game.engine;
+    if (game.replay_log != nullptr) {
+        game.replay_log->BeginSession(engine);
+    }
+    engine.GenerateRandomParams();
+    if (game.journal != nullptr) {
+        game.journal->RecordStart(game.player_id, engine);
+    }
+    while (!engine.IsGameOver()) {
+        if (co_await AskSaveAndExit{game}) {
+            if (SaveGame(game.player_id, engine)) {
+                if (game.journal != nullptr) {
+                    game.journal->RecordEnd(game.player_id, engine);
+                }
+                co_return;
+            }
+            GameIO::PrintMessage("Не удалось сохранить игру.");
+        }
+        const GameState& state = engine.game_state();
+        const int land_price = engine.land_price();
+        UserInputData decision;
+        GameIO::PrintMessage("Что пожелаешь, повелитель? Сколько акров земли повелеваешь купить?");
+        decision.acres_to_buy = co_await AskNumber{game, state.wheat_ / land_price, state.wheat_ / land_price};
+        GameIO::PrintMessage("Сколько акров земли повелеваешь продать?");
+        decision.acres_to_sell = co_await AskNumber{game, state.acres_, state.acres_};
+        GameIO::PrintMessage("Сколько акров земли повелеваешь засеять?");
+        // Planting has always accepted up to all the wheat, more than the prompt shows.
+        const int max_wheat_to_plant = std::min(state.wheat_, state.acres_);
+        decision.wheat_to_plant = co_await AskNumber{game, max_wheat_to_plant, std::max(state.wheat_, max_wheat_to_plant)};
+        GameIO::PrintMessage("Сколько бушелей пшеницы повелеваешь съесть?");
+        const int wheat_remaining = state.wheat_ - decision.acres_to_buy * land_price +
+                                    decision.acres_to_sell * land_price - decision.wheat_to_plant;
+        decision.wheat_to_eat = co_await AskNumber{game, wheat_remaining, wheat_remaining};
 
-    UpdateCityState(acres_to_buy, acres_to_sell, wheat_to_plant, wheat_to_eat);
+        if (game.replay_log != nullptr) {
+            game.replay_log->RecordDecision(decision);
+        }
+        const YearEvents events = engine.PlayYear(decision);
+        if (game.journal != nullptr) {
+            game.journal->RecordYear(game.player_id, decision, engine);
+        }
+        if (!engine.IsGameOver()) {
+            GameIO::PrintStatus(engine.game_state(), events);
+        }
+    }
+    if (game.journal != nullptr) {
+        game.journal->RecordEnd(game.player_id, engine);
+    }
+    if (game.replay_log != nullptr) {
+        game.replay_log->EndSession(engine);
+    }
+    if (game.leaderboard != nullptr) {
+        if (!game.leaderboard->Record(engine, game.player_id)) {
+            GameIO::PrintMessage("Не удалось записать правление в таблицу рекордов.");
+        }
+    }
+    GameIO::PrintResults(engine.CalculateResults());
 }
 
-void Game::PrintStatus() const {
-    std::cout << std::format("Мой повелитель, соизволь поведать тебе в году {}"
-                             " твоего высочайшего правления {} человек умерло от голода."
-                             " {} новых граждан прибыло в город. ",
-                             game_state_.year_, starvation_deaths_, new_citizens_);
-    if (plague_) {
-        std::cout << " Чума уничтожила половину населения. ";
+void Game::StartGame() {
+    Begin();
+    std::string_view line;
+    while (!IsOver()) {
+        GameIO::Output().Flush();
+        if (!GameIO::Input().ReadLine(line)) {
+            break;
+        }
+        Answer(line);
     }
-    std::cout << std::format(
-        "Население города сейчас составляет {} человек. "
-        "Мы собрали {} бушелей пшеницы, по {} бушелей с акра. "
-        "Крысы уничтожили {} бушелей пшеницы. У нас есть {} бушелей пшеницы и {} акров земли. "
-        "Цена акра земли составляет {} бушелей.\n",
-        game_state_.population_, game_state_.acres_ * wheat_per_acre_, wheat_per_acre_,
-        rats_ate_, game_state_.wheat_, game_state_.acres_, land_price_);
+    GameIO::Output().Flush();
 }
 
-void Game::CalculateResults() const {
-    if (game_state_.population_ == 0) {
-        std::cout << "Ваш город разорен. Игра окончена.\n";
-    } else if (starvation_deaths_ > kMaxStarvationDeaths * game_state_.population_) {
-        std::cout << "Слишком много смертей от голода. Игра окончена.\n";
-    } else {
-        const double acres_per_person = static_cast<double>(game_state_.acres_) / game_state_.population_;
-        const double average_starvation_deaths = static_cast<double>(total_starvation_deaths_) / game_state_.year_;
+void Game::Begin() {
+    if (!IsOver() && handle_.promise().question == Promise::Question::kNone) {
+        handle_.resume();
+    }
+}
 
-        if (average_starvation_deaths > 0.33 && acres_per_person < 7) {
-            std::cout << "Из-за вашей некомпетентности в управлении, народ устроил бунт, и изгнал вас их города. "
-                    "Теперь вы вынуждены влачить жалкое существование в изгнании";
-        } else if (average_starvation_deaths > 0.1 && acres_per_person < 9) {
-            std::cout << "Вы правили железной рукой, подобно Нерону и Ивану Грозному. "
-                    "Народ вздохнул с облегчением, и никто больше не желает видеть вас правителем";
-        } else if (average_starvation_deaths > 0.03 && acres_per_person < 10) {
-            std::cout <<
-                    "Вы справились вполне неплохо, у вас, конечно, есть недоброжелатели, но многие хотели бы увидеть вас во главе города снова";
-        } else {
-            std::cout << "Фантастика! Карл Великий, Дизраэли и Джефферсон вместе не справились бы лучше";
-        }
+void Game::Answer(const std::string_view line) {
+    if (IsOver()) {
+        return;
     }
+    Promise& game = handle_.promise();
+    switch (game.question) {
+        case Promise::Question::kNone:
+            return;
+        case Promise::Question::kYesNo:
+            game.answer = GameIO::IsYes(line);
+            break;
+        case Promise::Question::kNumber:
+            if (const auto value = GameIO::ParseAnswer(line, 0, game.accepted)) {
+                game.answer = *value;
+                break;
+            }
+            GameIO::PromptNumber(game.shown);
+            return;
+    }
+    game.question = Promise::Question::kNone;
+    handle_.resume();
+}
+
+bool Game::Save() const {
+    const Promise& game = handle_.promise();
+    if (!SaveGame(game.player_id, game.engine)) {
+        return false;
+    }
+    // The save holds the game now, so recovery must not offer it again.
+    if (game.journal != nullptr) {
+        game.journal->RecordEnd(game.player_id, game.engine);
+    }
+    return true;
+}
+
+void Game::SetPlayer(const std::uint64_t player_id) {
+    handle_.promise().player_id = player_id;
+}
+
+void Game::SetLeaderboard(Leaderboard* leaderboard) {
+    handle_.promise().leaderboard = leaderboard;
+}
+
+void Game::SetJournal(AutosaveJournal* journal) {
+    handle_.promise().journal = journal;
+}
+
+const GameEngine& Game::engine() const {
+    return handle_.promise().engine;
+}
+
+std::size_t Game::frame_size() {
+    return game_frame_size.load(std::memory_order_relaxed);
 }
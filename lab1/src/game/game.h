@@ -2,30 +2,76 @@
 
 #pragma once
 
-#include "game_state.h"
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
 
-class Game {
- private:
-    int starvation_deaths_;
-    int new_citizens_;
-    bool plague_;
-    int wheat_per_acre_;
-    int rats_ate_;
-    int land_price_;
-    int total_starvation_deaths_;
-    GameState game_state_;
+#include "game_engine.h"
+#include "../game_state/game_state.h"
+
+class AutosaveJournal;
+class Leaderboard;
+class ReplayLogWriter;
 
+// Interactive front-end over GameEngine. The turn loop is a coroutine that suspends whenever it
+// needs an answer, so the same game can be driven by a terminal, a bot or a network session
+// without a thread of its own: Begin() runs it up to the first question, and every Answer()
+// hands it one line and runs it up to the next question, until IsOver(). All text goes to
+// GameIO::Output(). StartGame() drives the whole game off GameIO::Input().
+//
+// All of a game's state lives in its coroutine frame, which comes from FramePool; a parked game
+// is just that frame, frame_size() bytes.
+class Game {
  public:
     Game();
-    explicit Game(const GameState&);
+    explicit Game(const GameEngine&, ReplayLogWriter* replay_log = nullptr);
+    explicit Game(const GameState&, ReplayLogWriter* replay_log = nullptr);
+    // A game that carries on from `snapshot`, asking the snapshot year's questions afresh.
+    explicit Game(const GameSnapshot& snapshot, ReplayLogWriter* replay_log = nullptr);
+    Game(Game&& other) noexcept;
+    Game& operator=(Game&& other) noexcept;
+    Game(const Game&) = delete;
+    Game& operator=(const Game&) = delete;
+    ~Game();
 
+    // Plays until the game is over or the input runs out, flushing output before every read.
     void StartGame();
-    void AskSaveAndExit() const;
-    void NextYear();
-    void GenerateRandomParams();
-    void PrintStatus() const;
-    void CalculateResults() const;
-    void UpdateCityState(int acres_to_buy, int acres_to_sell, int wheat_to_plant, int wheat_to_eat);
-    void UserInput();
-    [[nodiscard]] bool IsGameOver() const;
+    void Begin();
+    // Wrong answers get an error message and the question again.
+    void Answer(std::string_view line);
+    // Saves the game where the player's saves go; see SetPlayer(). A saved game ends in the journal.
+    bool Save() const;
+    // Saves go to this player's slot instead of the single save file.
+    void SetPlayer(std::uint64_t player_id);
+    // Every reign that ends (rather than being saved and left) is recorded on `leaderboard`.
+    void SetLeaderboard(Leaderboard* leaderboard);
+    // The start of the game, every year played and its end or save go to `journal`; set before Begin().
+    void SetJournal(AutosaveJournal* journal);
+
+    // True once the reign has ended or the player has saved and left.
+    [[nodiscard]] bool IsOver() const { return !handle_ || handle_.done(); }
+    // Not for a moved-from game.
+    [[nodiscard]] const GameEngine& engine() const;
+    // The game as it stands, without the answers given so far this year. Not for a moved-from game.
+    [[nodiscard]] GameSnapshot Snapshot() const { return engine().Snapshot(); }
+
+    // Size of a game's coroutine frame; 0 until the first game is created.
+    [[nodiscard]] static std::size_t frame_size();
+
+ private:
+    struct Promise;
+    using Handle = std::coroutine_handle<Promise>;
+
+    struct Turns {
+        using promise_type = Promise;
+        Handle handle;
+    };
+    struct Self;
+    struct AskSaveAndExit;
+    struct AskNumber;
+
+    Handle handle_;
+
+    static Turns Play(const GameEngine&, ReplayLogWriter*);
 };
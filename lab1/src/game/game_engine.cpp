@@ -0,0 +1,157 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include "game_engine.h"
+
+#include <algorithm>
+
+#include "../replay/year_trace.h"
+#include "../utils/random.h"
+
+UserInputData::UserInputData(): UserInputData(0, 0, 0, 0) {}
+
+UserInputData::UserInputData(const int acres_to_buy, const int acres_to_sell,
+                             const int wheat_to_plant, const int wheat_to_eat)
+    : acres_to_buy(acres_to_buy), acres_to_sell(acres_to_sell),
+      wheat_to_plant(wheat_to_plant), wheat_to_eat(wheat_to_eat) {
+}
+
+GameEngine::GameEngine(const GameState& game_state, const Ruleset* rules): starvation_deaths_(0), new_citizens_(0),
+              plague_(false), wheat_per_acre_(0), rats_ate_(0), land_price_(0),
+              total_starvation_deaths_(0), game_state_(game_state), rules_(rules), trace_(nullptr) {
+}
+
+GameEngine::GameEngine(const GameState& game_state, const YearState& year_state, const Ruleset* rules)
+    : starvation_deaths_(year_state.starvation_deaths), new_citizens_(year_state.new_citizens),
+      plague_(year_state.plague), wheat_per_acre_(year_state.wheat_per_acre), rats_ate_(year_state.rats_ate),
+      land_price_(year_state.land_price), total_starvation_deaths_(year_state.total_starvation_deaths),
+      game_state_(game_state), rules_(rules), trace_(nullptr) {
+}
+
+GameEngine::GameEngine(const GameSnapshot& snapshot, const Ruleset* rules)
+    : starvation_deaths_(snapshot.starvation_deaths), new_citizens_(snapshot.new_citizens),
+      plague_(snapshot.plague != 0), wheat_per_acre_(snapshot.wheat_per_acre), rats_ate_(snapshot.rats_ate),
+      land_price_(snapshot.land_price), total_starvation_deaths_(snapshot.total_starvation_deaths),
+      game_state_(snapshot.seed), rules_(rules), trace_(nullptr) {
+    game_state_.year_ = snapshot.year;
+    game_state_.population_ = snapshot.population;
+    game_state_.acres_ = snapshot.acres;
+    game_state_.wheat_ = snapshot.wheat;
+}
+
+GameEngine::GameEngine(): GameEngine(GameState()) {}
+
+YearState GameEngine::year_state() const {
+    return {starvation_deaths_, new_citizens_, plague_, wheat_per_acre_, rats_ate_, land_price_,
+            total_starvation_deaths_};
+}
+
+GameSnapshot GameEngine::Snapshot() const {
+    return {game_state_.seed_, game_state_.year_, game_state_.population_, game_state_.acres_, game_state_.wheat_,
+            starvation_deaths_, new_citizens_, wheat_per_acre_, rats_ate_, land_price_, total_starvation_deaths_,
+            plague_ ? 1 : 0};
+}
+
+void GameEngine::GenerateRandomParams() {
+    // A fresh stream per (seed, year) makes a year's events independent of how the game got there,
+    // so replays and resumed saves draw exactly the same numbers.
+    WithRules(rules_, [this](const auto& rules) {
+        Random random(SplitMix64(game_state_.seed_) ^ static_cast<std::uint64_t>(game_state_.year_));
+        plague_ = random.NextInRange(0, rules.plague_roll_max) < rules.plague_chance;
+        wheat_per_acre_ = random.NextInRange(rules.min_wheat_per_acre, rules.max_wheat_per_acre);
+        // The rats' share is drawn before the decision and taken after it, so a store can end a year
+        // in debt, and then there is nothing for them to eat.
+        rats_ate_ = random.NextInRange(
+            0, std::max(0, static_cast<int>(game_state_.wheat_ * rules.rats_wheat_consumption_fraction)));
+        land_price_ = random.NextInRange(rules.min_land_price, rules.max_land_price);
+    });
+}
+
+void GameEngine::UpdateCityState(const UserInputData& decision) {
+    game_state_.acres_ += decision.acres_to_buy - decision.acres_to_sell;
+    game_state_.wheat_ -= decision.wheat_to_eat + decision.wheat_to_plant;
+    game_state_.wheat_ += decision.acres_to_sell * wheat_per_acre_;
+    const int fed = WithRules(rules_, [&decision](const auto& rules) {
+        return decision.wheat_to_eat / rules.wheat_per_person;
+    });
+    starvation_deaths_ = std::max(0, game_state_.population_ - fed);
+}
+
+YearEvents GameEngine::NextYear() {
+    YearEvents events = ResolveYear();
+    if (!IsGameOver()) {
+        GenerateRandomParams();
+        events.land_price = land_price_;
+    }
+    return events;
+}
+
+YearEvents GameEngine::ResolveYear() {
+    game_state_.year_++;
+
+    const int harvest = game_state_.acres_ * wheat_per_acre_;
+    const int totalWheat = harvest - rats_ate_;
+    game_state_.wheat_ += totalWheat;
+
+    if (plague_) {
+        game_state_.population_ /= 2;
+    }
+
+    game_state_.population_ -= starvation_deaths_;
+
+    total_starvation_deaths_ += starvation_deaths_;
+    new_citizens_ = (starvation_deaths_ / 2 + (5 - wheat_per_acre_) * totalWheat / 600 + 1);
+    new_citizens_ = std::max(0, std::min(50, new_citizens_));
+
+    game_state_.population_ += new_citizens_;
+
+    if (trace_ != nullptr) {
+        trace_->Record(game_state_.seed_, game_state_.year_, harvest, rats_ate_, plague_, starvation_deaths_,
+                       new_citizens_, land_price_);
+    }
+    return {game_state_.year_, harvest, wheat_per_acre_, rats_ate_, plague_,
+            starvation_deaths_, new_citizens_, land_price_};
+}
+
+YearEvents GameEngine::PlayYear(const UserInputData& decision) {
+    UpdateCityState(decision);
+    return NextYear();
+}
+
+bool GameEngine::IsGameOver() const {
+    return WithRules(rules_, [this](const auto& rules) {
+        return starvation_deaths_ > rules.max_starvation_deaths * game_state_.population_ ||
+            game_state_.population_ == 0 || game_state_.year_ >= rules.max_years;
+    });
+}
+
+GameResult GameEngine::CalculateResults() const {
+    if (game_state_.population_ == 0) {
+        return GameResult::kRuined;
+    }
+    if (starvation_deaths_ > rules().max_starvation_deaths * game_state_.population_) {
+        return GameResult::kStarvation;
+    }
+    const double acres_per_person = static_cast<double>(game_state_.acres_) / game_state_.population_;
+    const double average_starvation_deaths = static_cast<double>(total_starvation_deaths_) / game_state_.year_;
+
+    if (average_starvation_deaths > 0.33 && acres_per_person < 7) {
+        return GameResult::kExiled;
+    }
+    if (average_starvation_deaths > 0.1 && acres_per_person < 9) {
+        return GameResult::kIronFist;
+    }
+    if (average_starvation_deaths > 0.03 && acres_per_person < 10) {
+        return GameResult::kAverage;
+    }
+    return GameResult::kFantastic;
+}
+
+UserInputData GameEngine::ClampDecision(const UserInputData& decision) const {
+    const int acres_to_buy = std::clamp(decision.acres_to_buy, 0, std::max(0, game_state_.wheat_ / land_price_));
+    const int acres_to_sell = std::clamp(decision.acres_to_sell, 0, game_state_.acres_);
+    const int wheat_to_plant = std::clamp(decision.wheat_to_plant, 0, std::max(0, game_state_.wheat_));
+    const int wheat_remaining = game_state_.wheat_ - acres_to_buy * land_price_ + acres_to_sell * land_price_ -
+                                wheat_to_plant;
+    const int wheat_to_eat = std::clamp(decision.wheat_to_eat, 0, std::max(0, wheat_remaining));
+    return {acres_to_buy, acres_to_sell, wheat_to_plant, wheat_to_eat};
+}
@@ -0,0 +1,137 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "ruleset.h"
+#include "../game_state/game_state.h"
+
+class YearTrace;
+
+class UserInputData {
+ public:
+    int acres_to_buy;
+    int acres_to_sell;
+    int wheat_to_plant;
+    int wheat_to_eat;
+
+    UserInputData();
+    UserInputData(int acres_to_buy, int acres_to_sell, int wheat_to_plant, int wheat_to_eat);
+};
+
+// What happened during the year that NextYear has just resolved,
+// plus the land price for the upcoming year.
+struct YearEvents {
+    int year;
+    int harvest;
+    int wheat_per_acre;
+    int rats_ate;
+    bool plague;
+    int starvation_deaths;
+    int new_citizens;
+    int land_price;
+};
+
+// The engine's per-year bookkeeping that is not part of GameState.
+struct YearState {
+    int starvation_deaths;
+    int new_citizens;
+    bool plague;
+    int wheat_per_acre;
+    int rats_ate;
+    int land_price;
+    int total_starvation_deaths;
+};
+
+// Everything an engine knows about a game, the year's hidden draws included, as one flat block.
+// Snapshots are trivially copyable, so forking a game into thousands of copies for look-ahead is a
+// memcpy. A copy replays this year's draws and, from next year on, whatever its seed gives: copies
+// meant to see different futures need seeds of their own. Rules and traces are not part of it.
+struct GameSnapshot {
+    std::uint64_t seed;
+    std::int32_t year;
+    std::int32_t population;
+    std::int32_t acres;
+    std::int32_t wheat;
+    std::int32_t starvation_deaths;
+    std::int32_t new_citizens;
+    std::int32_t wheat_per_acre;
+    std::int32_t rats_ate;
+    std::int32_t land_price;
+    std::int32_t total_starvation_deaths;
+    std::int32_t plague;
+};
+
+static_assert(std::is_trivial_v<GameSnapshot> && std::is_standard_layout_v<GameSnapshot>,
+              "forking a snapshot must be a plain copy");
+
+// Verdict tiers of CalculateResults, from worst to best.
+enum class GameResult {
+    kRuined,
+    kStarvation,
+    kExiled,
+    kIronFist,
+    kAverage,
+    kFantastic,
+};
+
+// Hammurabi rules without any I/O: state in, decision in, next state and events out.
+class GameEngine {
+ private:
+    int starvation_deaths_;
+    int new_citizens_;
+    bool plague_;
+    int wheat_per_acre_;
+    int rats_ate_;
+    int land_price_;
+    int total_starvation_deaths_;
+    GameState game_state_;
+    // Null for the stock rules, which are then compiled in as constants.
+    const Ruleset* rules_;
+    YearTrace* trace_;
+
+ public:
+    GameEngine();
+    // A non-null `rules` must outlive the engine and every copy of it.
+    explicit GameEngine(const GameState&, const Ruleset* rules = nullptr);
+    GameEngine(const GameState&, const YearState&, const Ruleset* rules = nullptr);
+    explicit GameEngine(const GameSnapshot&, const Ruleset* rules = nullptr);
+
+    // Appends every year this engine (or a copy of it) resolves to `trace`; null stops tracing.
+    void SetTrace(YearTrace* trace) { trace_ = trace; }
+
+    void GenerateRandomParams();
+    void UpdateCityState(const UserInputData& decision);
+    YearEvents NextYear();
+    // NextYear without drawing the following year's random parameters.
+    YearEvents ResolveYear();
+    YearEvents PlayYear(const UserInputData& decision);
+    [[nodiscard]] bool IsGameOver() const;
+    [[nodiscard]] GameResult CalculateResults() const;
+    // Limits a decision to the same bounds GameIO::UserInput accepts.
+    [[nodiscard]] UserInputData ClampDecision(const UserInputData& decision) const;
+
+    // Plays the reign to the end, asking `policy(const GameEngine&)` for every year's decision.
+    template<typename Policy>
+    GameResult PlayReign(Policy&& policy);
+
+    [[nodiscard]] const GameState& game_state() const { return game_state_; }
+    [[nodiscard]] const Ruleset& rules() const { return rules_ != nullptr ? *rules_ : kDefaultRuleset; }
+    [[nodiscard]] const Ruleset* custom_rules() const { return rules_; }
+    [[nodiscard]] YearState year_state() const;
+    [[nodiscard]] GameSnapshot Snapshot() const;
+    [[nodiscard]] int land_price() const { return land_price_; }
+    [[nodiscard]] int starvation_deaths() const { return starvation_deaths_; }
+    [[nodiscard]] int total_starvation_deaths() const { return total_starvation_deaths_; }
+};
+
+template<typename Policy>
+GameResult GameEngine::PlayReign(Policy&& policy) {
+    GenerateRandomParams();
+    while (!IsGameOver()) {
+        PlayYear(policy(static_cast<const GameEngine&>(*this)));
+    }
+    return CalculateResults();
+}
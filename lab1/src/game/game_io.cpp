@@ -4,71 +4,121 @@
 
 #include "game_io.h"
 
-#include <Game.h>
-#include <utils.h>
+#include "../game_state/game_state.h"
 
-#include "file_manager.h"
-#include "game_state.h"
+OutputSink* GameIO::output_ = nullptr;
+InputSource* GameIO::input_ = nullptr;
 
-UserInputData::UserInputData(int acres_to_buy, int acres_to_sell, int wheat_to_plant, int wheat_to_eat) {
-    return {acres_to_buy, acres_to_sell, wheat_to_plant, wheat_to_eat};
+void GameIO::SetOutput(OutputSink* sink) {
+    Output().Flush();
+    output_ = sink;
 }
 
-void GameIO::PrintMessage(const std::string& message) {
-    std::cout << message << std::endl;
+OutputSink& GameIO::Output() {
+    static FileSink stdout_sink(stdout);
+    return output_ != nullptr ? *output_ : stdout_sink;
 }
 
-void GameIO::PrintStatus(const GameState &game_state, const int starvation_deaths, const int land_price,
-                         const int new_citizens, const bool plague, const int rats_ate, const int wheat_per_acre) {
-    PrintMessage(std::format("Мой повелитель, соизволь поведать тебе в году {}"
-                             " твоего высочайшего правления {} человек умерло от голода."
-                             " {} новых граждан прибыло в город. ",
-                             game_state.year_, starvation_deaths, new_citizens));
-    if (plague) {
-        PrintMessage(" Чума уничтожила половину населения. ");
+void GameIO::SetInput(InputSource* source) {
+    input_ = source;
+}
+
+InputSource& GameIO::Input() {
+    static FileSource stdin_source(0);
+    return input_ != nullptr ? *input_ : stdin_source;
+}
+
+void GameIO::PrintMessage(const std::string_view message) {
+    OutputSink& output = Output();
+    output.Write(message);
+    output.Write("\n");
+}
+
+void GameIO::PrintStatus(const GameState &game_state, const YearEvents& events) {
+    OutputSink& output = Output();
+    output.Print("Мой повелитель, соизволь поведать тебе в году {}"
+                 " твоего высочайшего правления {} человек умерло от голода."
+                 " {} новых граждан прибыло в город. \n",
+                 game_state.year_, events.starvation_deaths, events.new_citizens);
+    if (events.plague) {
+        output.Write(" Чума уничтожила половину населения. \n");
+    }
+    output.Print("Население города сейчас составляет {} человек. "
+                 "Мы собрали {} бушелей пшеницы, по {} бушелей с акра. "
+                 "Крысы уничтожили {} бушелей пшеницы. У нас есть {} бушелей пшеницы и {} акров земли. "
+                 "Цена акра земли составляет {} бушелей.\n\n",
+                 game_state.population_, events.harvest, events.wheat_per_acre,
+                 events.rats_ate, game_state.wheat_, game_state.acres_, events.land_price);
+}
+
+void GameIO::PrintResults(const GameResult result) {
+    switch (result) {
+        case GameResult::kRuined:
+            PrintMessage("Ваш город разорен. Игра окончена.");
+            break;
+        case GameResult::kStarvation:
+            PrintMessage("Слишком много смертей от голода. Игра окончена.");
+            break;
+        case GameResult::kExiled:
+            PrintMessage("Из-за вашей некомпетентности в управлении, народ устроил бунт, и изгнал вас их города. "
+                    "Теперь вы вынуждены влачить жалкое существование в изгнании");
+            break;
+        case GameResult::kIronFist:
+            PrintMessage("Вы правили железной рукой, подобно Нерону и Ивану Грозному. "
+                    "Народ вздохнул с облегчением, и никто больше не желает видеть вас правителем");
+            break;
+        case GameResult::kAverage:
+            PrintMessage("Вы справились вполне неплохо, у вас, конечно, есть недоброжелатели, "
+                    "но многие хотели бы увидеть вас во главе города снова");
+            break;
+        case GameResult::kFantastic:
+            PrintMessage("Фантастика! Карл Великий, Дизраэли и Джефферсон вместе не справились бы лучше");
+            break;
     }
-    PrintMessage(std::format(
-        "Население города сейчас составляет {} человек. "
-        "Мы собрали {} бушелей пшеницы, по {} бушелей с акра. "
-        "Крысы уничтожили {} бушелей пшеницы. У нас есть {} бушелей пшеницы и {} акров земли. "
-        "Цена акра земли составляет {} бушелей.\n",
-        game_state.population_, game_state.acres_ * wheat_per_acre, wheat_per_acre,
-        rats_ate, game_state.wheat_, game_state.acres_, land_price));
 }
 
-bool GameIO::AskSaveAndExit(const GameState& game_state) {
-    std::cout << "Желаете сохранить игру и выйти? (y/n): ";
-    char choice;
-    std::cin >> choice;
-    if (choice == 'y') {
-        FileManager::SaveGame(game_state);
-        return true;
+void GameIO::PromptSaveAndExit() {
+    Output().Write("Желаете сохранить игру и выйти? (y/n): ");
+}
+
+void GameIO::PromptNumber(const int max) {
+    Output().Print("Введите число от 0 до {}: ", max);
+}
+
+bool GameIO::IsYes(const std::string_view answer) {
+    const auto first = answer.find_first_not_of(" \t");
+    return first != std::string_view::npos && answer[first] == 'y';
+}
+
+std::optional<int> GameIO::ParseAnswer(const std::string_view answer, const int min, const int max) {
+    int value;
+    if (!ParseInt(answer, value)) {
+        Output().Write("Ошибка: введите целое число.\n");
+    } else if (value < min || value > max) {
+        Output().Print("Ошибка: введите число в диапазоне от {} до {}.\n", min, max);
+    } else {
+        return value;
     }
-    return false;
+    return std::nullopt;
 }
 
-UserInputData GameIO::UserInput(const GameState& game_state, int land_price) {
-    std::cout << "Что пожелаешь, повелитель? ";
-    std::cout << "Сколько акров земли повелеваешь купить?\n";
-    const int max_acres_to_buy = game_state.wheat_ / land_price;
-    const int acres_to_buy = ValidateInput(0, max_acres_to_buy, "Введите число от 0 до " + std::to_string(max_acres_to_buy) + ": ");
-    std::cout << "Сколько акров земли повелеваешь продать?\n";
-    const int acres_to_sell = ValidateInput(0, game_state.acres_, "Введите число от 0 до " + std::to_string(game_state.acres_) + ": ");
-    std::cout << "Сколько акров земли повелеваешь засеять?\n";
-    const int max_wheat_to_plant = std::min(game_state.wheat_, game_state.acres_);
-    const int wheat_to_plant = ValidateInput(0, std::max(game_state.wheat_, max_wheat_to_plant), "Введите число от 0 до " + std::to_string(max_wheat_to_plant) + ": ");
-    std::cout << "Сколько бушелей пшеницы повелеваешь съесть?\n";
-    const int wheat_remaining = game_state.wheat_ - acres_to_buy * land_price + acres_to_sell * land_price - wheat_to_plant;
-    const int wheat_to_eat = ValidateInput(0, wheat_remaining, "Введите число от 0 до " + std::to_string(wheat_remaining) + ": ");
-
-    return UserInputData{acres_to_buy, acres_to_sell, wheat_to_plant, wheat_to_eat};
+bool GameIO::AskYesNo(const std::string_view prompt) {
+    Output().Write(prompt);
+    Output().Flush();
+    std::string_view line;
+    return Input().ReadLine(line) && IsYes(line);
 }
 
-int GameIO::GetUserInput(const std::string& prompt, int min, int max) {
-    int input;
-    do {
-        std::cout << prompt;
-        std::cin >> input;
-    } while (input < min || input > max);
-    return input;
+std::optional<int> GameIO::GetUserInput(const std::string_view prompt, const int min, const int max) {
+    while (true) {
+        Output().Write(prompt);
+        Output().Flush();
+        std::string_view line;
+        if (!Input().ReadLine(line)) {
+            return std::nullopt;
+        }
+        if (const auto value = ParseAnswer(line, min, max)) {
+            return value;
+        }
+    }
 }
@@ -4,29 +4,43 @@
 
 #pragma once
 
-#include <iostream>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <format>
 
-#include "game_state.h"
+#include "game_engine.h"
+#include "../game_state/game_state.h"
+#include "../io/input_source.h"
+#include "../io/output_sink.h"
 
-class UserInputData {
+class GameIO {
  public:
-    int acres_to_buy;
-    int acres_to_sell;
-    int wheat_to_plant;
-    int wheat_to_eat;
+    // Sends all game output to `sink` (stdout when null). The sink must outlive its use.
+    static void SetOutput(OutputSink* sink);
+    static OutputSink& Output();
+    // Reads all player input from `source` (stdin when null). The source must outlive its use.
+    static void SetInput(InputSource* source);
+    static InputSource& Input();
 
-    UserInputData(int acres_to_buy, int acres_to_sell, int wheat_to_plant, int wheat_to_eat);
-};
+    static void PrintMessage(std::string_view message);
+    static void PrintStatus(const GameState &game_state, const YearEvents& events);
+    static void PrintResults(GameResult result);
 
-class GameIO {
- public:
-    static void PrintMessage(const std::string& message);
-    static void PrintStatus(const GameState &game_state, int starvation_deaths, int land_price,
-                            int new_citizens, bool plague, int rats_ate, int wheat_per_acre);
-    static UserInputData UserInput(const GameState& game_state_, int land_price_);
+    // Prompts only; the answers arrive later through ParseAnswer and IsYes.
+    static void PromptSaveAndExit();
+    static void PromptNumber(int max);
+    [[nodiscard]] static bool IsYes(std::string_view answer);
+    // The answer as a number in [min, max]; otherwise prints what is wrong with it and returns nothing.
+    [[nodiscard]] static std::optional<int> ParseAnswer(std::string_view answer, int min, int max);
+
+    // Blocking helpers over Input().
+    // True only if the player answers 'y'; false on any other answer or at the end of input.
+    [[nodiscard]] static bool AskYesNo(std::string_view prompt);
+    // Re-prompts until a number in [min, max] is entered; nothing once the input runs out.
+    [[nodiscard]] static std::optional<int> GetUserInput(std::string_view prompt, int min, int max);
 
-    [[nodiscard]] static bool AskSaveAndExit(const GameState& game_state);
-    [[nodiscard]] static int GetUserInput(const std::string& prompt, int min, int max);
+ private:
+    static OutputSink* output_;
+    static InputSource* input_;
 };
@@ -0,0 +1,94 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include "ruleset.h"
+
+#include <charconv>
+#include <fstream>
+#include <string_view>
+#include <variant>
+
+namespace {
+
+using Field = std::variant<int Ruleset::*, double Ruleset::*>;
+
+struct NamedField {
+    std::string_view name;
+    Field field;
+};
+
+const NamedField kFields[] = {
+    {"max_years", &Ruleset::max_years},
+    {"wheat_per_person", &Ruleset::wheat_per_person},
+    {"max_starvation_deaths", &Ruleset::max_starvation_deaths},
+    {"rats_wheat_consumption_fraction", &Ruleset::rats_wheat_consumption_fraction},
+    {"plague_roll_max", &Ruleset::plague_roll_max},
+    {"plague_chance", &Ruleset::plague_chance},
+    {"min_wheat_per_acre", &Ruleset::min_wheat_per_acre},
+    {"max_wheat_per_acre", &Ruleset::max_wheat_per_acre},
+    {"min_land_price", &Ruleset::min_land_price},
+    {"max_land_price", &Ruleset::max_land_price},
+    {"initial_population", &Ruleset::initial_population},
+    {"initial_acres", &Ruleset::initial_acres},
+    {"initial_wheat", &Ruleset::initial_wheat},
+};
+
+std::string_view Trim(std::string_view text) {
+    const auto first = text.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+
+template<typename T>
+bool Parse(const std::string_view text, T& value) {
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size();
+}
+
+bool SetField(Ruleset& rules, const std::string_view name, const std::string_view value) {
+    for (const auto& [field_name, field] : kFields) {
+        if (field_name == name) {
+            return std::visit([&](auto member) { return Parse(value, rules.*member); }, field);
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+bool IsValidRuleset(const Ruleset& rules) {
+    return rules.max_years > 0 && rules.wheat_per_person > 0 &&
+           rules.max_starvation_deaths >= 0 && rules.max_starvation_deaths <= 1 &&
+           rules.rats_wheat_consumption_fraction >= 0 && rules.rats_wheat_consumption_fraction <= 1 &&
+           rules.plague_roll_max >= 0 && rules.plague_chance >= 0 && rules.plague_chance <= rules.plague_roll_max + 1 &&
+           rules.min_wheat_per_acre >= 0 && rules.min_wheat_per_acre <= rules.max_wheat_per_acre &&
+           rules.min_land_price > 0 && rules.min_land_price <= rules.max_land_price &&
+           rules.initial_population > 0 && rules.initial_acres >= 0 && rules.initial_wheat >= 0;
+}
+
+bool LoadRuleset(const std::string& path, Ruleset& rules) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    Ruleset loaded;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::string_view text(line);
+        text = Trim(text.substr(0, text.find('#')));
+        if (text.empty()) {
+            continue;
+        }
+        const auto equals = text.find('=');
+        if (equals == std::string_view::npos ||
+            !SetField(loaded, Trim(text.substr(0, equals)), Trim(text.substr(equals + 1)))) {
+            return false;
+        }
+    }
+    if (file.bad() || !IsValidRuleset(loaded)) {
+        return false;
+    }
+    rules = loaded;
+    return true;
+}
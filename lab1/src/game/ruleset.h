@@ -0,0 +1,65 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#pragma once
+
+#include <string>
+
+// Tunable rules of the game; the defaults are the stock rules.
+struct Ruleset {
+    int max_years = 10;
+    int wheat_per_person = 20;
+    // The game is lost when more than this share of the population starves in one year.
+    double max_starvation_deaths = 0.45;
+    double rats_wheat_consumption_fraction = 0.07;
+
+    // Ranges GenerateRandomParams draws from.
+    int plague_roll_max = 100;
+    int plague_chance = 15;
+    int min_wheat_per_acre = 1;
+    int max_wheat_per_acre = 6;
+    int min_land_price = 17;
+    int max_land_price = 26;
+
+    // The city a new game starts with.
+    int initial_population = 100;
+    int initial_acres = 1000;
+    int initial_wheat = 2800;
+};
+
+inline constexpr Ruleset kDefaultRuleset{};
+
+// The stock rules as compile-time constants. Rule code is written against `rules.field` and
+// instantiated both for a Ruleset and for DefaultRules, where every field folds into the arithmetic.
+struct DefaultRules {
+    static constexpr int max_years = kDefaultRuleset.max_years;
+    static constexpr int wheat_per_person = kDefaultRuleset.wheat_per_person;
+    static constexpr double max_starvation_deaths = kDefaultRuleset.max_starvation_deaths;
+    static constexpr double rats_wheat_consumption_fraction = kDefaultRuleset.rats_wheat_consumption_fraction;
+    static constexpr int plague_roll_max = kDefaultRuleset.plague_roll_max;
+    static constexpr int plague_chance = kDefaultRuleset.plague_chance;
+    static constexpr int min_wheat_per_acre = kDefaultRuleset.min_wheat_per_acre;
+    static constexpr int max_wheat_per_acre = kDefaultRuleset.max_wheat_per_acre;
+    static constexpr int min_land_price = kDefaultRuleset.min_land_price;
+    static constexpr int max_land_price = kDefaultRuleset.max_land_price;
+    static constexpr int initial_population = kDefaultRuleset.initial_population;
+    static constexpr int initial_acres = kDefaultRuleset.initial_acres;
+    static constexpr int initial_wheat = kDefaultRuleset.initial_wheat;
+};
+
+// Calls `fn(rules)` with DefaultRules when `rules` is null (the stock rules) and with `*rules` otherwise.
+template<typename Fn>
+decltype(auto) WithRules(const Ruleset* rules, Fn&& fn) {
+    if (rules == nullptr) {
+        return fn(DefaultRules{});
+    }
+    return fn(*rules);
+}
+
+// Reads a ruleset from "name = value" lines, where the names are the Ruleset fields and '#' starts
+// a comment. Fields that are not mentioned keep their stock values. Returns false and leaves `rules`
+// untouched if the file cannot be read, has an unknown name or a malformed value, or the result is
+// not a playable ruleset.
+bool LoadRuleset(const std::string& path, Ruleset& rules);
+
+// Whether the game can be played under `rules`: non-empty ranges, positive divisors, sane fractions.
+[[nodiscard]] bool IsValidRuleset(const Ruleset& rules);
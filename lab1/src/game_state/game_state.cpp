@@ -4,9 +4,12 @@
 
 #include "game_state.h"
 
-constexpr int kInitPopulation = 100;
-constexpr int kInitAcres = 1000;
-constexpr int kInitWheat = 2800;
+#include "../utils/random.h"
 
-GameState::GameState(): year_(0), population_(kInitPopulation), acres_(kInitAcres), wheat_(kInitWheat) {}
+GameState::GameState(): GameState(ThreadRandom().Next()) {}
 
+GameState::GameState(const std::uint64_t seed): GameState(seed, kDefaultRuleset) {}
+
+GameState::GameState(const std::uint64_t seed, const Ruleset& rules)
+    : year_(0), population_(rules.initial_population), acres_(rules.initial_acres), wheat_(rules.initial_wheat),
+      seed_(seed) {}
@@ -4,12 +4,21 @@
 
 #pragma once
 
+#include <cstdint>
+
+#include "../game/ruleset.h"
+
 class GameState {
  public:
     int year_;
     int population_;
     int acres_;
     int wheat_;
+    // Session seed: every year's random events are derived from it and year_.
+    std::uint64_t seed_;
 
     GameState();
-};
\ No newline at end of file
+    explicit GameState(std::uint64_t seed);
+    // The starting city of `rules`.
+    GameState(std::uint64_t seed, const Ruleset& rules);
+};
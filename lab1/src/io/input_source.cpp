@@ -0,0 +1,135 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include "input_source.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <poll.h>
+    #include <unistd.h>
+#endif
+
+bool InputSource::ReadLine(std::string_view& line) {
+    return NextLine(line, true) == Status::kLine;
+}
+
+InputSource::Status InputSource::PollLine(std::string_view& line) {
+    return NextLine(line, false);
+}
+
+InputSource::Status InputSource::NextLine(std::string_view& line, const bool wait) {
+    while (true) {
+        const char* first = buffer_.data() + begin_;
+        const auto* newline = static_cast<const char*>(std::memchr(first, '\n', end_ - begin_));
+        if (newline != nullptr) {
+            line = std::string_view(first, newline - first);
+            begin_ = newline + 1 - buffer_.data();
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            return Status::kLine;
+        }
+        // A last line without a line break, or one longer than the whole buffer, is returned as is.
+        if ((at_end_ && begin_ < end_) || (begin_ == 0 && end_ == kBufferSize)) {
+            line = std::string_view(first, end_ - begin_);
+            begin_ = end_;
+            return Status::kLine;
+        }
+        if (at_end_) {
+            return Status::kEnd;
+        }
+        if (begin_ > 0) {
+            std::memmove(buffer_.data(), first, end_ - begin_);
+            end_ -= begin_;
+            begin_ = 0;
+        }
+        const std::ptrdiff_t count = ReadIn(buffer_.data() + end_, kBufferSize - end_, wait);
+        if (count == kNotReady) {
+            return Status::kPending;
+        }
+        if (count <= 0) {
+            at_end_ = true;
+        } else {
+            end_ += static_cast<std::size_t>(count);
+        }
+    }
+}
+
+#ifdef _WIN32
+FileSource::FileSource(const std::string& path): fd_(_open(path.c_str(), _O_RDONLY | _O_BINARY)), owned_(true) {}
+#else
+FileSource::FileSource(const std::string& path): fd_(open(path.c_str(), O_RDONLY)), owned_(true) {}
+#endif
+
+FileSource::FileSource(const int fd): fd_(fd), owned_(false) {}
+
+FileSource::~FileSource() {
+    if (owned_ && fd_ >= 0) {
+#ifdef _WIN32
+        _close(fd_);
+#else
+        close(fd_);
+#endif
+    }
+}
+
+std::ptrdiff_t FileSource::ReadIn(char* data, const std::size_t size, const bool wait) {
+    if (fd_ < 0) {
+        return 0;
+    }
+#ifdef _WIN32
+    // There is no portable readiness check for consoles and pipes here, so polling waits too.
+    (void)wait;
+    return std::max(_read(fd_, data, static_cast<unsigned>(size)), 0);
+#else
+    if (!wait) {
+        pollfd request{fd_, POLLIN, 0};
+        if (poll(&request, 1, 0) == 0) {
+            return kNotReady;
+        }
+    }
+    while (true) {
+        const ssize_t count = read(fd_, data, size);
+        if (count >= 0) {
+            return count;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return kNotReady;
+        }
+        if (errno != EINTR) {
+            return 0;
+        }
+    }
+#endif
+}
+
+ScriptSource::ScriptSource(std::string script): script_(std::move(script)) {}
+
+std::ptrdiff_t ScriptSource::ReadIn(char* data, const std::size_t size, bool) {
+    const std::size_t count = std::min(size, script_.size() - position_);
+    std::memcpy(data, script_.data() + position_, count);
+    position_ += count;
+    return static_cast<std::ptrdiff_t>(count);
+}
+
+bool ParseInt(std::string_view text, int& value) {
+    const auto first = text.find_first_not_of(" \t");
+    if (first == std::string_view::npos) {
+        return false;
+    }
+    text = text.substr(first, text.find_last_not_of(" \t") - first + 1);
+    const char* begin = text.data();
+    // from_chars takes no leading '+', which people do type.
+    if (text.size() > 1 && text[0] == '+' && text[1] != '-') {
+        ++begin;
+    }
+    const auto [end, error] = std::from_chars(begin, text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size();
+}
@@ -0,0 +1,83 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Line-oriented text input. Data is read in large chunks into a fixed buffer owned by the source
+// and handed out a whole line at a time as views into that buffer. There is no stream state to
+// clear after bad input and nothing is allocated per line.
+class InputSource {
+ public:
+    static constexpr std::size_t kBufferSize = 64 * 1024;
+
+    enum class Status {
+        kLine,     // a line was returned
+        kPending,  // no whole line has arrived yet, try again later
+        kEnd,      // the input is exhausted
+    };
+
+    InputSource() = default;
+    InputSource(const InputSource&) = delete;
+    InputSource& operator=(const InputSource&) = delete;
+    virtual ~InputSource() = default;
+
+    // Next line without its line break. The view stays valid until the next call.
+    // Waits for input; false at the end of input.
+    bool ReadLine(std::string_view& line);
+    // Same as ReadLine, but never waits.
+    Status PollLine(std::string_view& line);
+
+ protected:
+    static constexpr std::ptrdiff_t kNotReady = -1;
+
+    // Reads up to `size` bytes into `data`. Returns the number of bytes read, 0 at the end of
+    // input or on error, or kNotReady if `wait` is false and nothing is available right now.
+    virtual std::ptrdiff_t ReadIn(char* data, std::size_t size, bool wait) = 0;
+
+ private:
+    std::array<char, kBufferSize> buffer_;
+    std::size_t begin_ = 0;
+    std::size_t end_ = 0;
+    bool at_end_ = false;
+
+    Status NextLine(std::string_view& line, bool wait);
+};
+
+// Reads from a file, or from any open file descriptor such as stdin or a pipe.
+class FileSource final : public InputSource {
+ public:
+    // Opens the file at `path` for reading; see IsOpen().
+    explicit FileSource(const std::string& path);
+    // Reads from `fd` without taking ownership of it.
+    explicit FileSource(int fd);
+    ~FileSource() override;
+
+    [[nodiscard]] bool IsOpen() const { return fd_ >= 0; }
+
+ protected:
+    std::ptrdiff_t ReadIn(char* data, std::size_t size, bool wait) override;
+
+ private:
+    int fd_;
+    bool owned_;
+};
+
+// Reads from text held in memory, for bots and tests that script a whole session up front.
+class ScriptSource final : public InputSource {
+ public:
+    explicit ScriptSource(std::string script);
+
+ protected:
+    std::ptrdiff_t ReadIn(char* data, std::size_t size, bool wait) override;
+
+ private:
+    std::string script_;
+    std::size_t position_ = 0;
+};
+
+// Parses a whole line as a decimal integer, ignoring surrounding blanks.
+[[nodiscard]] bool ParseInt(std::string_view text, int& value);
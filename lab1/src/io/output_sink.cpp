@@ -0,0 +1,64 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include "output_sink.h"
+
+#include <algorithm>
+#include <cstring>
+
+void OutputSink::Write(std::string_view text) {
+    while (!text.empty()) {
+        if (used_ == kBufferSize) {
+            Drain();
+        }
+        const std::size_t chunk = std::min(text.size(), kBufferSize - used_);
+        std::memcpy(buffer_.data() + used_, text.data(), chunk);
+        used_ += chunk;
+        text.remove_prefix(chunk);
+    }
+}
+
+void OutputSink::Drain() {
+    if (used_ > 0) {
+        good_ = WriteOut(buffer_.data(), used_) && good_;
+        used_ = 0;
+    }
+}
+
+bool OutputSink::Flush() {
+    Drain();
+    good_ = FlushOut() && good_;
+    return good_;
+}
+
+FileSink::FileSink(const std::string& path, const bool append)
+    : file_(std::fopen(path.c_str(), append ? "ab" : "wb")), owned_(true) {}
+
+FileSink::FileSink(std::FILE* file): file_(file), owned_(false) {}
+
+FileSink::~FileSink() {
+    Flush();
+    if (owned_ && file_ != nullptr) {
+        std::fclose(file_);
+    }
+}
+
+bool FileSink::WriteOut(const char* data, const std::size_t size) {
+    return file_ != nullptr && std::fwrite(data, 1, size, file_) == size;
+}
+
+bool FileSink::FlushOut() {
+    return file_ != nullptr && std::fflush(file_) == 0;
+}
+
+void StringSink::SetTarget(std::string* target) {
+    Flush();
+    target_ = target;
+}
+
+bool StringSink::WriteOut(const char* data, const std::size_t size) {
+    if (target_ == nullptr) {
+        return false;
+    }
+    target_->append(data, size);
+    return true;
+}
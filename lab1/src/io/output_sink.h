@@ -0,0 +1,127 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <format>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+// Buffered text output. Messages are formatted straight into a fixed buffer owned by the sink
+// and handed to the destination in large chunks, when the buffer fills up or on Flush().
+// Nothing is allocated per message.
+class OutputSink {
+ public:
+    static constexpr std::size_t kBufferSize = 64 * 1024;
+
+    OutputSink() = default;
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+    virtual ~OutputSink() = default;
+
+    template<typename... Args>
+    void Print(std::format_string<Args...> format, Args&&... args);
+    void Write(std::string_view text);
+    // Hands everything buffered to the destination; false if any write so far has failed.
+    bool Flush();
+
+    [[nodiscard]] bool good() const { return good_; }
+
+ protected:
+    // Derived sinks must call Flush() in their destructors; the base class cannot,
+    // because WriteOut is already gone by then.
+    virtual bool WriteOut(const char* data, std::size_t size) = 0;
+    virtual bool FlushOut() { return true; }
+
+ private:
+    // Output iterator for messages longer than the whole buffer.
+    class Inserter {
+     public:
+        using difference_type = std::ptrdiff_t;
+
+        explicit Inserter(OutputSink& sink): sink_(&sink) {}
+        Inserter& operator*() { return *this; }
+        Inserter& operator++() { return *this; }
+        Inserter operator++(int) { return *this; }
+        Inserter& operator=(const char c) {
+            sink_->Write(std::string_view(&c, 1));
+            return *this;
+        }
+
+     private:
+        OutputSink* sink_;
+    };
+
+    std::array<char, kBufferSize> buffer_;
+    std::size_t used_ = 0;
+    bool good_ = true;
+
+    void Drain();
+};
+
+template<typename... Args>
+void OutputSink::Print(std::format_string<Args...> format, Args&&... args) {
+    const std::size_t free = kBufferSize - used_;
+    const auto result = std::format_to_n(buffer_.data() + used_, static_cast<std::ptrdiff_t>(free), format, args...);
+    const auto size = static_cast<std::size_t>(result.size);
+    if (size <= free) {
+        used_ += size;
+        return;
+    }
+    // The message did not fit: send what was there before it and format it again.
+    Drain();
+    if (size <= kBufferSize) {
+        std::format_to_n(buffer_.data(), static_cast<std::ptrdiff_t>(kBufferSize), format, args...);
+        used_ = size;
+    } else {
+        std::format_to(Inserter(*this), format, args...);
+    }
+}
+
+// Writes to a file, or to any already open stdio stream such as stdout or a pipe from popen().
+class FileSink final : public OutputSink {
+ public:
+    // Creates or truncates (or appends to) the file at `path`; see IsOpen().
+    explicit FileSink(const std::string& path, bool append = false);
+    // Writes to `file` without taking ownership of it.
+    explicit FileSink(std::FILE* file);
+    ~FileSink() override;
+
+    [[nodiscard]] bool IsOpen() const { return file_ != nullptr; }
+
+ protected:
+    bool WriteOut(const char* data, std::size_t size) override;
+    bool FlushOut() override;
+
+ private:
+    std::FILE* file_;
+    bool owned_;
+};
+
+// Discards everything, for runs where nobody watches.
+class NullSink final : public OutputSink {
+ public:
+    ~NullSink() override { Flush(); }
+
+ protected:
+    bool WriteOut(const char*, std::size_t) override { return true; }
+};
+
+// Appends to a string owned by the caller, which can be switched between messages.
+class StringSink final : public OutputSink {
+ public:
+    explicit StringSink(std::string* target = nullptr): target_(target) {}
+    ~StringSink() override { Flush(); }
+
+    // Flushes into the old target first.
+    void SetTarget(std::string* target);
+
+ protected:
+    bool WriteOut(const char* data, std::size_t size) override;
+
+ private:
+    std::string* target_;
+};
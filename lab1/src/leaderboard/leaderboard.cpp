@@ -0,0 +1,215 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include "leaderboard.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+
+#include "../simulation/monte_carlo.h"
+
+constexpr char kLeaderboardMagic[4] = {'H', 'M', 'L', 'B'};
+constexpr std::uint32_t kLeaderboardVersion = 1;
+
+namespace {
+
+struct FileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t record_size;
+    std::uint32_t reserved;
+};
+
+// Sketch buckets of one verdict: 1/16 acre per person up to 16, then 64 per octave up to 2^20.
+constexpr int kLinearBuckets = 256;
+constexpr int kOctaveBuckets = 64;
+constexpr int kOctaves = 16;
+constexpr std::size_t kBucketsPerResult = kLinearBuckets + kOctaves * kOctaveBuckets;
+constexpr std::size_t kBuckets = kGameResultCount * kBucketsPerResult;
+constexpr std::size_t kReadBatch = 4096;
+
+std::size_t AcresBucket(const float acres_per_person) {
+    if (!(acres_per_person > 0)) {
+        return 0;
+    }
+    if (acres_per_person < 16) {
+        return static_cast<std::size_t>(acres_per_person * 16);
+    }
+    int exponent;
+    // acres_per_person = fraction * 2^exponent with fraction in [0.5, 1).
+    const double fraction = std::frexp(static_cast<double>(acres_per_person), &exponent);
+    const int octave = exponent - 5;
+    if (octave >= kOctaves) {
+        return kBucketsPerResult - 1;
+    }
+    return kLinearBuckets + octave * kOctaveBuckets + static_cast<int>((fraction * 2 - 1) * kOctaveBuckets);
+}
+
+std::size_t BucketOf(const ReignRecord& reign) {
+    const auto result = static_cast<std::size_t>(std::clamp(reign.result, 0, kGameResultCount - 1));
+    return result * kBucketsPerResult + AcresBucket(reign.acres_per_person);
+}
+
+}  // namespace
+
+ReignRecord MakeReignRecord(const GameEngine& engine, const std::uint64_t player_id) {
+    const GameState& state = engine.game_state();
+    ReignRecord reign{};
+    reign.seed = state.seed_;
+    reign.player_id = player_id;
+    reign.years = state.year_;
+    reign.population = state.population_;
+    reign.acres = state.acres_;
+    reign.wheat = state.wheat_;
+    reign.total_starvation_deaths = engine.total_starvation_deaths();
+    reign.result = static_cast<std::int32_t>(engine.CalculateResults());
+    reign.acres_per_person = state.population_ > 0 ? static_cast<float>(state.acres_) / state.population_ : 0.0f;
+    reign.average_starvation =
+        state.year_ > 0 ? static_cast<float>(engine.total_starvation_deaths()) / state.year_ : 0.0f;
+    return reign;
+}
+
+bool IsBetterReign(const ReignRecord& a, const ReignRecord& b) {
+    if (a.result != b.result) {
+        return a.result > b.result;
+    }
+    if (a.acres_per_person != b.acres_per_person) {
+        return a.acres_per_person > b.acres_per_person;
+    }
+    if (a.average_starvation != b.average_starvation) {
+        return a.average_starvation < b.average_starvation;
+    }
+    return a.population > b.population;
+}
+
+Leaderboard::Leaderboard(const std::size_t top_size)
+    : top_size_(std::max<std::size_t>(1, top_size)), buckets_(kBuckets + 1, 0), count_(0), file_(nullptr) {
+    top_.reserve(top_size_);
+}
+
+Leaderboard::~Leaderboard() {
+    if (file_ != nullptr) {
+        std::fclose(file_);
+    }
+}
+
+bool Leaderboard::Open(const std::string& path) {
+    if (file_ != nullptr) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+    top_.clear();
+    std::fill(buckets_.begin(), buckets_.end(), 0);
+    count_ = 0;
+
+    std::error_code error;
+    if (const std::filesystem::path directory = std::filesystem::path(path).parent_path(); !directory.empty()) {
+        std::filesystem::create_directories(directory, error);
+    }
+    std::uint64_t records = 0;
+    bool is_new = true;
+    if (std::FILE* existing = std::fopen(path.c_str(), "rb"); existing != nullptr) {
+        FileHeader header{};
+        const std::size_t header_read = std::fread(&header, sizeof(header), 1, existing);
+        is_new = header_read == 0 && std::feof(existing);
+        if (!is_new && (header_read != 1 || std::memcmp(header.magic, kLeaderboardMagic, sizeof(header.magic)) != 0 ||
+                        header.version != kLeaderboardVersion || header.record_size != sizeof(ReignRecord))) {
+            std::fclose(existing);
+            return false;
+        }
+        std::vector<ReignRecord> batch(kReadBatch);
+        for (std::size_t read; (read = std::fread(batch.data(), sizeof(ReignRecord), batch.size(), existing)) > 0;) {
+            for (std::size_t i = 0; i < read; ++i) {
+                Index(batch[i]);
+            }
+            records += read;
+        }
+        std::fclose(existing);
+    }
+    if (!is_new) {
+        // Cut off a torn record so that appends stay aligned to whole records.
+        std::filesystem::resize_file(path, sizeof(FileHeader) + records * sizeof(ReignRecord), error);
+        if (error) {
+            return false;
+        }
+    }
+
+    file_ = std::fopen(path.c_str(), is_new ? "wb" : "ab");
+    if (file_ == nullptr) {
+        return false;
+    }
+    std::setvbuf(file_, nullptr, _IOFBF, std::size_t{1} << 20);
+    if (is_new) {
+        FileHeader header{};
+        std::memcpy(header.magic, kLeaderboardMagic, sizeof(header.magic));
+        header.version = kLeaderboardVersion;
+        header.record_size = sizeof(ReignRecord);
+        return std::fwrite(&header, sizeof(header), 1, file_) == 1;
+    }
+    return true;
+}
+
+bool Leaderboard::Flush() {
+    return file_ == nullptr || std::fflush(file_) == 0;
+}
+
+bool Leaderboard::Record(const ReignRecord& reign) {
+    Index(reign);
+    if (file_ == nullptr || std::fwrite(&reign, sizeof(reign), 1, file_) == 1) {
+        return true;
+    }
+    // Part of the record may have reached the file; Open cuts it off, but later records appended
+    // after it would be out of line.
+    std::fclose(file_);
+    file_ = nullptr;
+    return false;
+}
+
+void Leaderboard::Index(const ReignRecord& reign) {
+    ++count_;
+    for (std::size_t i = BucketOf(reign) + 1; i < buckets_.size(); i += i & (~i + 1)) {
+        ++buckets_[i];
+    }
+    // Ordered by IsBetterReign, the heap keeps its worst reign in front.
+    if (top_.size() < top_size_) {
+        top_.push_back(reign);
+        std::push_heap(top_.begin(), top_.end(), IsBetterReign);
+    } else if (IsBetterReign(reign, top_.front())) {
+        std::pop_heap(top_.begin(), top_.end(), IsBetterReign);
+        top_.back() = reign;
+        std::push_heap(top_.begin(), top_.end(), IsBetterReign);
+    }
+}
+
+std::uint64_t Leaderboard::CountUpTo(const std::size_t bucket) const {
+    std::uint64_t count = 0;
+    for (std::size_t i = bucket + 1; i > 0; i -= i & (~i + 1)) {
+        count += buckets_[i];
+    }
+    return count;
+}
+
+std::vector<ReignRecord> Leaderboard::Top() const {
+    std::vector<ReignRecord> best = top_;
+    std::sort(best.begin(), best.end(), IsBetterReign);
+    return best;
+}
+
+std::uint64_t Leaderboard::Rank(const ReignRecord& reign) const {
+    const auto better_in_top = static_cast<std::uint64_t>(std::count_if(
+        top_.begin(), top_.end(), [&reign](const ReignRecord& other) { return IsBetterReign(other, reign); }));
+    // The heap holds every reign better than one that would make it into the heap.
+    if (count_ == top_.size() || IsBetterReign(reign, top_.front())) {
+        return better_in_top;
+    }
+    // Below the top: everything in better buckets, and half of the reign's own bucket.
+    const std::size_t bucket = BucketOf(reign);
+    const std::uint64_t up_to = CountUpTo(bucket);
+    const std::uint64_t same = up_to - (bucket > 0 ? CountUpTo(bucket - 1) : 0);
+    return std::max(better_in_top, count_ - up_to + same / 2);
+}
+
+double Leaderboard::Percentile(const ReignRecord& reign) const {
+    return count_ > 0 ? 100.0 * static_cast<double>(count_ - Rank(reign)) / static_cast<double>(count_) : 100.0;
+}
@@ -0,0 +1,84 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../game/game_engine.h"
+
+// One finished reign, written to the leaderboard file as one block in host byte order.
+struct ReignRecord {
+    std::uint64_t seed;
+    // 0 for games without a player slot.
+    std::uint64_t player_id;
+    std::int32_t years;
+    std::int32_t population;
+    std::int32_t acres;
+    std::int32_t wheat;
+    std::int32_t total_starvation_deaths;
+    // A GameResult.
+    std::int32_t result;
+    float acres_per_person;
+    // Starvation deaths per year, as CalculateResults averages them.
+    float average_starvation;
+};
+
+static_assert(sizeof(ReignRecord) == 48, "ReignRecord layout is part of the leaderboard format");
+
+ReignRecord MakeReignRecord(const GameEngine& engine, std::uint64_t player_id = 0);
+// Reigns rank by verdict, then acres per person, then fewer deaths per year, then population.
+[[nodiscard]] bool IsBetterReign(const ReignRecord& a, const ReignRecord& b);
+
+// Persistent ranking of finished reigns. Every reign is appended to a file of fixed-size records
+// and added to two in-memory indexes: a heap of the best top_size() reigns, and a sketch that
+// counts reigns per (verdict, acres per person) bucket in a Fenwick tree. Buckets are 1/16 acre
+// wide below 16 acres per person and 1/64 of an octave above, so recording a reign and asking for
+// a rank take a few dozen steps and never scan the records; ranks are exact within the top and
+// approximate, to a bucket, below it. Not safe to share between threads.
+class Leaderboard {
+ public:
+    explicit Leaderboard(std::size_t top_size = 100);
+    ~Leaderboard();
+    Leaderboard(const Leaderboard&) = delete;
+    Leaderboard& operator=(const Leaderboard&) = delete;
+
+    // Opens or creates the record file and indexes the reigns already in it. A record torn off by a
+    // crash at the end of the file is dropped. False if the file cannot be opened or is not a
+    // leaderboard; the board then stays in memory only.
+    bool Open(const std::string& path);
+    // Writes buffered records to the file; false on a write error.
+    bool Flush();
+
+    // Indexes the reign and appends it to the file. False if the append fails; the board then stays
+    // in memory only, as after a failed Open.
+    bool Record(const ReignRecord& reign);
+    bool Record(const GameEngine& engine, std::uint64_t player_id = 0) {
+        return Record(MakeReignRecord(engine, player_id));
+    }
+
+    [[nodiscard]] std::uint64_t size() const { return count_; }
+    [[nodiscard]] std::size_t top_size() const { return top_size_; }
+    // The best reigns recorded, best first.
+    [[nodiscard]] std::vector<ReignRecord> Top() const;
+    // How many recorded reigns are better than `reign`: 0 for the best.
+    [[nodiscard]] std::uint64_t Rank(const ReignRecord& reign) const;
+    // Share of recorded reigns, in percent, that are not better than `reign`: 100 for the best.
+    [[nodiscard]] double Percentile(const ReignRecord& reign) const;
+
+ private:
+    void Index(const ReignRecord& reign);
+    // Reigns in buckets [0, bucket].
+    [[nodiscard]] std::uint64_t CountUpTo(std::size_t bucket) const;
+
+    std::size_t top_size_;
+    // Min-heap under IsBetterReign: the worst of the best is at the front.
+    std::vector<ReignRecord> top_;
+    // Fenwick tree over the sketch buckets, worst bucket first.
+    std::vector<std::uint64_t> buckets_;
+    std::uint64_t count_;
+    std::FILE* file_;
+};
@@ -0,0 +1,226 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include "replay_log.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+
+constexpr char kMagic[4] = {'H', 'M', 'R', 'L'};
+constexpr unsigned char kVersion = 1;
+
+enum RecordTag : unsigned char {
+    kSessionTag = 'S',
+    kDecisionTag = 'D',
+    kEndTag = 'E',
+};
+
+namespace {
+
+// Longest record: tag, seed, four state fields and seven year state fields.
+constexpr std::size_t kMaxRecordSize = 1 + 10 + 11 * 5;
+
+class RecordBuilder {
+ public:
+    explicit RecordBuilder(const RecordTag tag) { bytes_[size_++] = tag; }
+
+    void PutUnsigned(std::uint64_t value) {
+        while (value >= 0x80) {
+            bytes_[size_++] = static_cast<unsigned char>(value | 0x80);
+            value >>= 7;
+        }
+        bytes_[size_++] = static_cast<unsigned char>(value);
+    }
+
+    void PutInt(const int value) {
+        const auto wide = static_cast<std::int64_t>(value);
+        PutUnsigned(static_cast<std::uint64_t>(wide << 1) ^ static_cast<std::uint64_t>(wide >> 63));
+    }
+
+    void PutState(const GameState& game_state) {
+        PutInt(game_state.year_);
+        PutInt(game_state.population_);
+        PutInt(game_state.acres_);
+        PutInt(game_state.wheat_);
+    }
+
+    void PutYearState(const YearState& year_state) {
+        PutInt(year_state.starvation_deaths);
+        PutInt(year_state.new_citizens);
+        PutInt(year_state.plague ? 1 : 0);
+        PutInt(year_state.wheat_per_acre);
+        PutInt(year_state.rats_ate);
+        PutInt(year_state.land_price);
+        PutInt(year_state.total_starvation_deaths);
+    }
+
+    void WriteTo(std::ofstream& file) const {
+        file.write(reinterpret_cast<const char*>(bytes_), static_cast<std::streamsize>(size_));
+    }
+
+ private:
+    unsigned char bytes_[kMaxRecordSize];
+    std::size_t size_ = 0;
+};
+
+class RecordParser {
+ public:
+    RecordParser(const std::vector<unsigned char>& data, std::size_t& position)
+        : data_(data), position_(position) {}
+
+    bool GetUnsigned(std::uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && position_ < data_.size(); shift += 7) {
+            const unsigned char byte = data_[position_++];
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool GetInt(int& value) {
+        std::uint64_t raw;
+        if (!GetUnsigned(raw)) {
+            return false;
+        }
+        value = static_cast<int>(static_cast<std::int64_t>(raw >> 1) ^ -static_cast<std::int64_t>(raw & 1));
+        return true;
+    }
+
+    bool GetState(GameState& game_state) {
+        return GetInt(game_state.year_) && GetInt(game_state.population_) &&
+               GetInt(game_state.acres_) && GetInt(game_state.wheat_);
+    }
+
+    bool GetYearState(YearState& year_state) {
+        int plague;
+        if (!GetInt(year_state.starvation_deaths) || !GetInt(year_state.new_citizens) || !GetInt(plague) ||
+            !GetInt(year_state.wheat_per_acre) || !GetInt(year_state.rats_ate) || !GetInt(year_state.land_price) ||
+            !GetInt(year_state.total_starvation_deaths)) {
+            return false;
+        }
+        year_state.plague = plague != 0;
+        return true;
+    }
+
+ private:
+    const std::vector<unsigned char>& data_;
+    std::size_t& position_;
+};
+
+}  // namespace
+
+ReplayLogWriter::ReplayLogWriter(const std::string& path) {
+    std::error_code error;
+    if (const std::filesystem::path directory = std::filesystem::path(path).parent_path(); !directory.empty()) {
+        std::filesystem::create_directories(directory, error);
+    }
+    const bool is_new = !std::filesystem::exists(path, error) || std::filesystem::file_size(path, error) == 0;
+    file_.open(path, std::ios::binary | std::ios::app);
+    if (is_new && file_.is_open()) {
+        file_.write(kMagic, sizeof(kMagic));
+        file_.put(static_cast<char>(kVersion));
+    }
+}
+
+ReplayLogWriter::~ReplayLogWriter() {
+    file_.flush();
+}
+
+bool ReplayLogWriter::IsOpen() const {
+    return file_.is_open();
+}
+
+void ReplayLogWriter::BeginSession(const GameEngine& engine) {
+    RecordBuilder record(kSessionTag);
+    record.PutUnsigned(engine.game_state().seed_);
+    record.PutState(engine.game_state());
+    record.PutYearState(engine.year_state());
+    record.WriteTo(file_);
+}
+
+void ReplayLogWriter::RecordDecision(const UserInputData& decision) {
+    RecordBuilder record(kDecisionTag);
+    record.PutInt(decision.acres_to_buy);
+    record.PutInt(decision.acres_to_sell);
+    record.PutInt(decision.wheat_to_plant);
+    record.PutInt(decision.wheat_to_eat);
+    record.WriteTo(file_);
+}
+
+void ReplayLogWriter::EndSession(const GameEngine& engine) {
+    RecordBuilder record(kEndTag);
+    record.PutState(engine.game_state());
+    record.PutUnsigned(static_cast<std::uint64_t>(engine.CalculateResults()));
+    record.WriteTo(file_);
+    file_.flush();
+}
+
+ReplayLogReader::ReplayLogReader(const std::string& path): position_(sizeof(kMagic) + 1), valid_(false) {
+    if (std::ifstream file(path, std::ios::binary); file.is_open()) {
+        data_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    valid_ = data_.size() >= position_ && std::equal(kMagic, kMagic + sizeof(kMagic), data_.begin()) &&
+             data_[sizeof(kMagic)] == kVersion;
+}
+
+bool ReplayLogReader::IsValid() const {
+    return valid_;
+}
+
+bool ReplayLogReader::Next(ReplaySession& session) {
+    if (!valid_ || position_ >= data_.size() || data_[position_] != kSessionTag) {
+        return false;
+    }
+    ++position_;
+    RecordParser parser(data_, position_);
+    session = ReplaySession();
+    if (!parser.GetUnsigned(session.initial_state.seed_) || !parser.GetState(session.initial_state) ||
+        !parser.GetYearState(session.initial_year_state)) {
+        return false;
+    }
+
+    while (position_ < data_.size() && data_[position_] == kDecisionTag) {
+        ++position_;
+        UserInputData decision;
+        if (!parser.GetInt(decision.acres_to_buy) || !parser.GetInt(decision.acres_to_sell) ||
+            !parser.GetInt(decision.wheat_to_plant) || !parser.GetInt(decision.wheat_to_eat)) {
+            return false;
+        }
+        session.decisions.push_back(decision);
+    }
+
+    if (position_ < data_.size() && data_[position_] == kEndTag) {
+        ++position_;
+        std::uint64_t result;
+        session.final_state.seed_ = session.initial_state.seed_;
+        if (!parser.GetState(session.final_state) || !parser.GetUnsigned(result)) {
+            return false;
+        }
+        session.result = static_cast<GameResult>(result);
+        session.finished = true;
+    }
+    return true;
+}
+
+GameEngine Replay(const ReplaySession& session) {
+    GameEngine engine(session.initial_state, session.initial_year_state);
+    engine.GenerateRandomParams();
+    for (const UserInputData& decision : session.decisions) {
+        engine.PlayYear(decision);
+    }
+    return engine;
+}
+
+bool ValidateReplay(const ReplaySession& session) {
+    const GameEngine engine = Replay(session);
+    if (!session.finished) {
+        return !engine.IsGameOver();
+    }
+    const GameState& state = engine.game_state();
+    return engine.IsGameOver() && engine.CalculateResults() == session.result &&
+           state.year_ == session.final_state.year_ && state.population_ == session.final_state.population_ &&
+           state.acres_ == session.final_state.acres_ && state.wheat_ == session.final_state.wheat_;
+}
@@ -0,0 +1,64 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../game/game_engine.h"
+#include "../game_state/game_state.h"
+
+// One logged game: the engine it started from (its state with the seed, and its
+// year state) and every decision made. A finished session also carries the
+// verdict and the final state.
+struct ReplaySession {
+    GameState initial_state;
+    // Taken before the first year's draws, so a resumed game replays with the
+    // starvation total it carried in.
+    YearState initial_year_state{};
+    std::vector<UserInputData> decisions;
+    bool finished = false;
+    GameResult result = GameResult::kRuined;
+    GameState final_state;
+};
+
+// Appends sessions to a binary replay log. After a short file header every
+// record is a one-byte tag followed by zigzag varint fields, so a typical
+// decision takes about 10 bytes.
+class ReplayLogWriter {
+ public:
+    explicit ReplayLogWriter(const std::string& path);
+    ~ReplayLogWriter();
+
+    [[nodiscard]] bool IsOpen() const;
+    // Logs the whole engine, so that a resumed game replays from where it was resumed.
+    void BeginSession(const GameEngine& engine);
+    void RecordDecision(const UserInputData& decision);
+    void EndSession(const GameEngine& engine);
+
+ private:
+    std::ofstream file_;
+};
+
+// Reads a whole replay log into memory and hands out its sessions in order.
+class ReplayLogReader {
+ public:
+    explicit ReplayLogReader(const std::string& path);
+
+    [[nodiscard]] bool IsValid() const;
+    // Returns false once the log is exhausted or a truncated record is hit.
+    bool Next(ReplaySession& session);
+
+ private:
+    std::vector<unsigned char> data_;
+    std::size_t position_;
+    bool valid_;
+};
+
+// Re-simulates a logged session without prompting.
+GameEngine Replay(const ReplaySession& session);
+// True if the replay ends the way the log says the game ended.
+bool ValidateReplay(const ReplaySession& session);
@@ -0,0 +1,600 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include "session_archive.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+constexpr char kArchiveMagic[4] = {'H', 'M', 'A', 'R'};
+constexpr char kArchiveEndMagic[4] = {'H', 'M', 'A', 'E'};
+constexpr std::uint32_t kArchiveVersion = 1;
+
+namespace {
+
+struct FileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t sessions_per_block;
+    std::uint32_t reserved;
+};
+
+// Follows the block index at the very end of the file.
+struct FileFooter {
+    std::uint64_t sessions;
+    std::uint64_t index_offset;
+    char magic[4];
+    std::uint32_t reserved;
+};
+
+// Widths of the bit-packed fields; the all-ones value of each is the escape to a full number.
+constexpr int kYearsBits = 4;
+constexpr int kWheatPerAcreBits = 3;
+constexpr int kLandPriceBits = 4;
+// Four unchanged decision fields and the stock year flag.
+constexpr std::size_t kMinYearBits = 5;
+// A year takes at most 12 numbers of 65 bits and a few flags and fields, a session header less
+// than that, so a reader that checks its position once per year never runs past this much padding.
+constexpr std::size_t kReadPadding = 256;
+
+// All the arithmetic below wraps in 32 bits, so that any int round-trips, however odd.
+std::uint32_t Wrap(const int value) {
+    return static_cast<std::uint32_t>(value);
+}
+
+int Unwrap(const std::uint32_t value) {
+    return static_cast<int>(value);
+}
+
+std::uint32_t ZigZag(const std::uint32_t value) {
+    return (value << 1) ^ (0 - (value >> 31));
+}
+
+std::uint32_t UnZigZag(const std::uint32_t value) {
+    return (value >> 1) ^ (0 - (value & 1));
+}
+
+// What the stock rules would draw for the year that starts from `state`.
+YearState StockDraws(const GameState& state) {
+    GameEngine engine(state);
+    engine.GenerateRandomParams();
+    return engine.year_state();
+}
+
+bool SameDraws(const YearEvents& events, const YearState& draws, const int land_price) {
+    return events.plague == draws.plague && events.wheat_per_acre == draws.wheat_per_acre &&
+           events.rats_ate == draws.rats_ate && events.land_price == land_price;
+}
+
+// The stock arithmetic of UpdateCityState and ResolveYear, field by field, in the order a year is
+// decoded: each prediction may use the fields decoded before it.
+std::uint32_t PredictAcres(const GameState& previous, const UserInputData& decision) {
+    return Wrap(previous.acres_) + Wrap(decision.acres_to_buy) - Wrap(decision.acres_to_sell);
+}
+
+std::uint32_t PredictStarvationDeaths(const GameState& previous, const UserInputData& decision) {
+    const std::int64_t fed = decision.wheat_to_eat / kDefaultRuleset.wheat_per_person;
+    return static_cast<std::uint32_t>(std::max<std::int64_t>(0, previous.population_ - fed));
+}
+
+std::uint32_t PredictNewCitizens(const YearEvents& events, const int acres) {
+    const std::int64_t total_wheat = std::int64_t{acres} * events.wheat_per_acre - events.rats_ate;
+    const std::int64_t born =
+        events.starvation_deaths / 2 + (5 - std::int64_t{events.wheat_per_acre}) * total_wheat / 600 + 1;
+    return static_cast<std::uint32_t>(std::clamp<std::int64_t>(born, 0, 50));
+}
+
+std::uint32_t PredictPopulation(const GameState& previous, const YearEvents& events) {
+    const int survivors = events.plague ? previous.population_ / 2 : previous.population_;
+    return Wrap(survivors) - Wrap(events.starvation_deaths) + Wrap(events.new_citizens);
+}
+
+std::uint32_t PredictWheat(const GameState& previous, const UserInputData& decision, const YearEvents& events,
+                           const int acres) {
+    return Wrap(previous.wheat_) - Wrap(decision.wheat_to_eat) - Wrap(decision.wheat_to_plant) +
+           Wrap(decision.acres_to_sell) * Wrap(events.wheat_per_acre) + Wrap(acres) * Wrap(events.wheat_per_acre) -
+           Wrap(events.rats_ate);
+}
+
+// The Exp-Golomb order for a decision field, from its value the year before: values of similar size
+// then take a few bits more than their width.
+int NextOrder(const std::uint32_t value) {
+    return std::max(0, static_cast<int>(std::bit_width(ZigZag(value))) - 2);
+}
+
+// Grain that feeds everyone, the usual amount to eat.
+std::uint32_t PredictWheatToEat(const GameState& previous) {
+    return Wrap(previous.population_) * Wrap(kDefaultRuleset.wheat_per_person);
+}
+
+// Writes bits most significant first.
+class BitWriter {
+ public:
+    explicit BitWriter(std::vector<unsigned char>& out): out_(out) {}
+
+    void Put(const std::uint64_t bits, const int count) {
+        buffer_ = (buffer_ << count) | bits;
+        used_ += count;
+        while (used_ >= 8) {
+            used_ -= 8;
+            out_.push_back(static_cast<unsigned char>(buffer_ >> used_));
+        }
+    }
+
+    // Exp-Golomb: as many zeros as `value + 1` has bits after its leading one, then `value + 1`.
+    void PutNumber(const std::uint32_t value) {
+        const std::uint64_t shifted = std::uint64_t{value} + 1;
+        const int width = std::bit_width(shifted);
+        Put(0, width - 1);
+        if (width > 32) {
+            Put(shifted >> 32, width - 32);
+            Put(shifted & 0xFFFFFFFF, 32);
+        } else {
+            Put(shifted, width);
+        }
+    }
+
+    void PutSigned(const std::uint32_t value) { PutNumber(ZigZag(value)); }
+
+    // Exp-Golomb of order `order`: the high bits as above, then the `order` low bits as they are.
+    void PutSigned(const std::uint32_t value, const int order) {
+        const std::uint32_t zigzag = ZigZag(value);
+        PutNumber(zigzag >> order);
+        Put(zigzag & ((std::uint32_t{1} << order) - 1), order);
+    }
+
+    // `value - min` in `bits` bits, or the escape and the whole value.
+    void PutSmall(const int value, const int min, const int bits) {
+        const std::uint32_t escape = (std::uint32_t{1} << bits) - 1;
+        const std::uint32_t offset = Wrap(value) - Wrap(min);
+        if (offset < escape) {
+            Put(offset, bits);
+        } else {
+            Put(escape, bits);
+            PutSigned(Wrap(value));
+        }
+    }
+
+    // Pads the last byte with zeros.
+    void Finish() {
+        if (used_ > 0) {
+            Put(0, 8 - used_);
+        }
+    }
+
+ private:
+    std::vector<unsigned char>& out_;
+    std::uint64_t buffer_ = 0;
+    int used_ = 0;
+};
+
+class BitReader {
+ public:
+    BitReader(const unsigned char* data, const std::size_t bit): data_(data), bit_(bit) {}
+
+    // The next 57 bits at least, most significant first.
+    [[nodiscard]] std::uint64_t Peek() const {
+        std::uint64_t word;
+        std::memcpy(&word, data_ + bit_ / 8, sizeof(word));
+        return __builtin_bswap64(word) << (bit_ % 8);
+    }
+
+    // Up to 57 bits.
+    std::uint64_t Get(const int count) {
+        const std::uint64_t bits = Peek() >> (64 - count);
+        bit_ += count;
+        return bits;
+    }
+
+    std::uint32_t GetNumber() {
+        const std::uint64_t window = Peek();
+        const int zeros = std::countl_zero(window);
+        if (zeros <= 28) {
+            const int width = 2 * zeros + 1;
+            bit_ += width;
+            return static_cast<std::uint32_t>((window >> (64 - width)) - 1);
+        }
+        if (zeros > 32) {
+            failed_ = true;
+            return 0;
+        }
+        bit_ += zeros;
+        return static_cast<std::uint32_t>(Get(zeros + 1) - 1);
+    }
+
+    std::uint32_t GetSigned() { return UnZigZag(GetNumber()); }
+
+    std::uint32_t GetSigned(const int order) {
+        const std::uint32_t high = GetNumber() << order;
+        return UnZigZag(order > 0 ? high | static_cast<std::uint32_t>(Get(order)) : high);
+    }
+
+    int GetSmall(const int min, const int bits) {
+        const auto offset = static_cast<std::uint32_t>(Get(bits));
+        if (offset == (std::uint32_t{1} << bits) - 1) {
+            return Unwrap(GetSigned());
+        }
+        return Unwrap(Wrap(min) + offset);
+    }
+
+    void Align() { bit_ = (bit_ + 7) / 8 * 8; }
+
+    [[nodiscard]] std::size_t bit() const { return bit_; }
+    [[nodiscard]] bool failed() const { return failed_; }
+
+ private:
+    const unsigned char* data_;
+    std::size_t bit_;
+    bool failed_ = false;
+};
+
+void EncodeSession(const ArchivedSession& session, BitWriter& out) {
+    const GameState& initial = session.initial_state;
+    out.Put(initial.seed_ >> 32, 32);
+    out.Put(initial.seed_ & 0xFFFFFFFF, 32);
+    out.PutSmall(static_cast<int>(session.years.size()), 0, kYearsBits);
+    out.PutSigned(Wrap(initial.year_));
+    out.PutSigned(Wrap(initial.population_) - Wrap(kDefaultRuleset.initial_population));
+    out.PutSigned(Wrap(initial.acres_) - Wrap(kDefaultRuleset.initial_acres));
+    out.PutSigned(Wrap(initial.wheat_) - Wrap(kDefaultRuleset.initial_wheat));
+    YearState draws = StockDraws(initial);
+    out.Put(session.initial_land_price == draws.land_price ? 1 : 0, 1);
+    if (session.initial_land_price != draws.land_price) {
+        out.PutSmall(session.initial_land_price, kDefaultRuleset.min_land_price, kLandPriceBits);
+    }
+    // One bit for a new game; a resumed one spells out the year state it carries over.
+    const bool resumed = session.initial_starvation_deaths != 0 || session.initial_new_citizens != 0 ||
+                         session.initial_total_starvation_deaths != 0;
+    out.Put(resumed ? 1 : 0, 1);
+    if (resumed) {
+        out.PutSigned(Wrap(session.initial_starvation_deaths));
+        out.PutSigned(Wrap(session.initial_new_citizens));
+        out.PutSigned(Wrap(session.initial_total_starvation_deaths));
+    }
+
+    const GameState* previous = &initial;
+    UserInputData previous_decision;
+    int land_price = session.initial_land_price;
+    int orders[4] = {0, 0, 0, 0};
+    for (std::size_t i = 0; i < session.years.size(); ++i) {
+        const ArchivedYear& year = session.years[i];
+        const UserInputData& decision = year.decision;
+        const YearEvents& events = year.events;
+        const std::uint32_t changes[4] = {
+            Wrap(decision.acres_to_buy) - Wrap(previous_decision.acres_to_buy),
+            Wrap(decision.acres_to_sell) - Wrap(previous_decision.acres_to_sell),
+            Wrap(decision.wheat_to_plant) - Wrap(previous_decision.wheat_to_plant),
+            Wrap(decision.wheat_to_eat) - PredictWheatToEat(*previous),
+        };
+        for (int field = 0; field < 4; ++field) {
+            out.PutSigned(changes[field], orders[field]);
+            orders[field] = NextOrder(changes[field]);
+        }
+
+        // The last year keeps its price; every other one draws next year's from the city it leaves.
+        const YearState next_draws = StockDraws(year.state);
+        const bool stock_draws =
+            SameDraws(events, draws, i + 1 < session.years.size() ? next_draws.land_price : land_price);
+        const std::uint32_t errors[5] = {
+            Wrap(year.state.acres_) - PredictAcres(*previous, decision),
+            Wrap(events.starvation_deaths) - PredictStarvationDeaths(*previous, decision),
+            Wrap(events.new_citizens) - PredictNewCitizens(events, year.state.acres_),
+            Wrap(year.state.population_) - PredictPopulation(*previous, events),
+            Wrap(year.state.wheat_) - PredictWheat(*previous, decision, events, year.state.acres_),
+        };
+        // A year that went exactly by the stock rules takes one bit past the decision.
+        const bool stock_year =
+            stock_draws && std::all_of(errors, errors + 5, [](const std::uint32_t error) { return error == 0; });
+        out.Put(stock_year ? 1 : 0, 1);
+        if (!stock_year) {
+            out.Put(stock_draws ? 1 : 0, 1);
+            if (!stock_draws) {
+                out.Put(events.plague ? 1 : 0, 1);
+                out.PutSmall(events.wheat_per_acre, kDefaultRuleset.min_wheat_per_acre, kWheatPerAcreBits);
+                out.PutSigned(Wrap(events.rats_ate));
+                out.PutSmall(events.land_price, kDefaultRuleset.min_land_price, kLandPriceBits);
+            }
+            for (const std::uint32_t error : errors) {
+                out.PutSigned(error);
+            }
+        }
+        previous = &year.state;
+        previous_decision = decision;
+        land_price = events.land_price;
+        draws = next_draws;
+    }
+    out.Finish();
+}
+
+// Decodes the session at `bit` and moves `bit` past it; false if it runs past `end_bit` or hits a malformed number.
+bool DecodeSession(const unsigned char* data, std::size_t& bit, const std::size_t end_bit,
+                   ArchivedSession& session) {
+    // A local reader keeps its position in a register.
+    BitReader in(data, bit);
+    GameState& initial = session.initial_state;
+    initial.seed_ = in.Get(32) << 32;
+    initial.seed_ |= in.Get(32);
+    const int years = in.GetSmall(0, kYearsBits);
+    initial.year_ = Unwrap(in.GetSigned());
+    initial.population_ = Unwrap(Wrap(kDefaultRuleset.initial_population) + in.GetSigned());
+    initial.acres_ = Unwrap(Wrap(kDefaultRuleset.initial_acres) + in.GetSigned());
+    initial.wheat_ = Unwrap(Wrap(kDefaultRuleset.initial_wheat) + in.GetSigned());
+    YearState draws = StockDraws(initial);
+    session.initial_land_price = in.Get(1) != 0 ? draws.land_price
+                                                : in.GetSmall(kDefaultRuleset.min_land_price, kLandPriceBits);
+    if (in.Get(1) != 0) {
+        session.initial_starvation_deaths = Unwrap(in.GetSigned());
+        session.initial_new_citizens = Unwrap(in.GetSigned());
+        session.initial_total_starvation_deaths = Unwrap(in.GetSigned());
+    } else {
+        session.initial_starvation_deaths = 0;
+        session.initial_new_citizens = 0;
+        session.initial_total_starvation_deaths = 0;
+    }
+    // Every year takes at least kMinYearBits, which bounds what a damaged count can allocate.
+    if (years < 0 || in.failed() || in.bit() > end_bit ||
+        static_cast<std::size_t>(years) > (end_bit - in.bit()) / kMinYearBits) {
+        return false;
+    }
+    session.years.resize(static_cast<std::size_t>(years));
+
+    const GameState* previous = &initial;
+    UserInputData previous_decision;
+    int land_price = session.initial_land_price;
+    int orders[4] = {0, 0, 0, 0};
+    for (std::size_t i = 0; i < session.years.size(); ++i) {
+        ArchivedYear& year = session.years[i];
+        UserInputData& decision = year.decision;
+        YearEvents& events = year.events;
+        GameState& state = year.state;
+        std::uint32_t changes[4];
+        for (int field = 0; field < 4; ++field) {
+            changes[field] = in.GetSigned(orders[field]);
+            orders[field] = NextOrder(changes[field]);
+        }
+        decision.acres_to_buy = Unwrap(Wrap(previous_decision.acres_to_buy) + changes[0]);
+        decision.acres_to_sell = Unwrap(Wrap(previous_decision.acres_to_sell) + changes[1]);
+        decision.wheat_to_plant = Unwrap(Wrap(previous_decision.wheat_to_plant) + changes[2]);
+        decision.wheat_to_eat = Unwrap(PredictWheatToEat(*previous) + changes[3]);
+
+        const bool stock_year = in.Get(1) != 0;
+        const bool stock_draws = stock_year || in.Get(1) != 0;
+        if (stock_draws) {
+            events.plague = draws.plague;
+            events.wheat_per_acre = draws.wheat_per_acre;
+            events.rats_ate = draws.rats_ate;
+        } else {
+            events.plague = in.Get(1) != 0;
+            events.wheat_per_acre = in.GetSmall(kDefaultRuleset.min_wheat_per_acre, kWheatPerAcreBits);
+            events.rats_ate = Unwrap(in.GetSigned());
+            events.land_price = in.GetSmall(kDefaultRuleset.min_land_price, kLandPriceBits);
+        }
+        // Each field is predicted from the ones before it and corrected unless the year was stock.
+        const auto error = [&in, stock_year] { return stock_year ? 0 : in.GetSigned(); };
+        state.seed_ = initial.seed_;
+        state.year_ = previous->year_ + 1;
+        state.acres_ = Unwrap(PredictAcres(*previous, decision) + error());
+        events.starvation_deaths = Unwrap(PredictStarvationDeaths(*previous, decision) + error());
+        events.new_citizens = Unwrap(PredictNewCitizens(events, state.acres_) + error());
+        state.population_ = Unwrap(PredictPopulation(*previous, events) + error());
+        state.wheat_ = Unwrap(PredictWheat(*previous, decision, events, state.acres_) + error());
+        events.year = state.year_;
+        events.harvest = Unwrap(Wrap(state.acres_) * Wrap(events.wheat_per_acre));
+        if (in.failed() || in.bit() > end_bit) {
+            return false;
+        }
+
+        // Next year's draws come from the city this year left, and so does this year's price.
+        draws = StockDraws(state);
+        if (stock_draws) {
+            events.land_price = i + 1 < session.years.size() ? draws.land_price : land_price;
+        }
+        previous = &state;
+        previous_decision = decision;
+        land_price = events.land_price;
+    }
+    in.Align();
+    bit = in.bit();
+    return bit <= end_bit;
+}
+
+bool WriteAll(std::FILE* file, const void* data, const std::size_t size) {
+    return std::fwrite(data, 1, size, file) == size;
+}
+
+}  // namespace
+
+void ArchivedSession::Begin(const GameEngine& engine) {
+    initial_state = engine.game_state();
+    initial_land_price = engine.land_price();
+    const YearState year_state = engine.year_state();
+    initial_starvation_deaths = year_state.starvation_deaths;
+    initial_new_citizens = year_state.new_citizens;
+    initial_total_starvation_deaths = year_state.total_starvation_deaths;
+    years.clear();
+}
+
+void ArchivedSession::AddYear(const UserInputData& decision, const YearEvents& events, const GameEngine& engine) {
+    years.push_back({decision, events, engine.game_state()});
+}
+
+GameEngine ReplayArchived(const ArchivedSession& session) {
+    GameEngine engine(session.initial_state, YearState{session.initial_starvation_deaths, session.initial_new_citizens,
+                                                       false, 0, 0, 0, session.initial_total_starvation_deaths});
+    engine.GenerateRandomParams();
+    for (const ArchivedYear& year : session.years) {
+        engine.PlayYear(year.decision);
+    }
+    return engine;
+}
+
+bool ArchiveReplay(const ReplaySession& session, ArchivedSession& archived) {
+    GameEngine engine(session.initial_state, session.initial_year_state);
+    engine.GenerateRandomParams();
+    archived.Begin(engine);
+    for (const UserInputData& decision : session.decisions) {
+        archived.AddYear(decision, engine.PlayYear(decision), engine);
+    }
+    const GameState& state = engine.game_state();
+    return !session.finished ||
+           (engine.IsGameOver() && engine.CalculateResults() == session.result &&
+            state.year_ == session.final_state.year_ && state.population_ == session.final_state.population_ &&
+            state.acres_ == session.final_state.acres_ && state.wheat_ == session.final_state.wheat_);
+}
+
+SessionArchiveWriter::~SessionArchiveWriter() {
+    if (file_ != nullptr) {
+        Close();
+    }
+}
+
+bool SessionArchiveWriter::Open(const std::string& path) {
+    if (file_ != nullptr) {
+        Close();
+    }
+    file_ = std::fopen(path.c_str(), "wb");
+    if (file_ == nullptr) {
+        return false;
+    }
+    std::setvbuf(file_, nullptr, _IOFBF, std::size_t{1} << 20);
+    sessions_ = 0;
+    block_.clear();
+    block_offsets_.clear();
+
+    FileHeader header{};
+    std::memcpy(header.magic, kArchiveMagic, sizeof(header.magic));
+    header.version = kArchiveVersion;
+    header.sessions_per_block = kSessionsPerBlock;
+    offset_ = sizeof(header);
+    return WriteAll(file_, &header, sizeof(header));
+}
+
+bool SessionArchiveWriter::Add(const ArchivedSession& session) {
+    if (file_ == nullptr) {
+        return false;
+    }
+    BitWriter out(block_);
+    EncodeSession(session, out);
+    ++sessions_;
+    return sessions_ % kSessionsPerBlock != 0 || WriteBlock();
+}
+
+bool SessionArchiveWriter::WriteBlock() {
+    block_offsets_.push_back(offset_);
+    offset_ += block_.size();
+    const bool written = WriteAll(file_, block_.data(), block_.size());
+    block_.clear();
+    return written;
+}
+
+bool SessionArchiveWriter::Close() {
+    if (file_ == nullptr) {
+        return false;
+    }
+    bool written = sessions_ % kSessionsPerBlock == 0 || WriteBlock();
+    FileFooter footer{};
+    footer.sessions = sessions_;
+    footer.index_offset = offset_;
+    std::memcpy(footer.magic, kArchiveEndMagic, sizeof(footer.magic));
+    written = written && WriteAll(file_, block_offsets_.data(), block_offsets_.size() * sizeof(std::uint64_t)) &&
+              WriteAll(file_, &footer, sizeof(footer));
+    written = std::fclose(file_) == 0 && written;
+    file_ = nullptr;
+    return written;
+}
+
+bool SessionArchiveReader::Open(const std::string& path) {
+    data_.clear();
+    block_offsets_.clear();
+    sessions_ = 0;
+    next_ = 0;
+    if (std::ifstream file(path, std::ios::binary); file.is_open()) {
+        data_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    file_size_ = data_.size();
+    FileHeader header{};
+    FileFooter footer{};
+    if (file_size_ < sizeof(header) + sizeof(footer)) {
+        return false;
+    }
+    std::memcpy(&header, data_.data(), sizeof(header));
+    std::memcpy(&footer, data_.data() + file_size_ - sizeof(footer), sizeof(footer));
+    if (std::memcmp(header.magic, kArchiveMagic, sizeof(header.magic)) != 0 || header.version != kArchiveVersion ||
+        header.sessions_per_block == 0 || std::memcmp(footer.magic, kArchiveEndMagic, sizeof(footer.magic)) != 0) {
+        return false;
+    }
+    const std::uint64_t blocks = (footer.sessions + header.sessions_per_block - 1) / header.sessions_per_block;
+    const std::size_t index_end = file_size_ - sizeof(footer);
+    if (footer.index_offset < sizeof(header) || footer.index_offset > index_end ||
+        (index_end - footer.index_offset) / sizeof(std::uint64_t) != blocks) {
+        return false;
+    }
+    block_offsets_.resize(blocks + 1);
+    std::memcpy(block_offsets_.data(), data_.data() + footer.index_offset, blocks * sizeof(std::uint64_t));
+    block_offsets_[blocks] = footer.index_offset;
+    for (std::size_t block = 0; block < blocks; ++block) {
+        if (block_offsets_[block] > block_offsets_[block + 1] || block_offsets_[block] < sizeof(header)) {
+            block_offsets_.clear();
+            return false;
+        }
+    }
+    sessions_ = footer.sessions;
+    sessions_per_block_ = header.sessions_per_block;
+    data_.resize(file_size_ + kReadPadding, 0);
+    return true;
+}
+
+bool SessionArchiveReader::StartBlock(const std::uint64_t block) {
+    if (block + 1 >= block_offsets_.size()) {
+        return false;
+    }
+    next_ = block * sessions_per_block_;
+    bit_ = block_offsets_[block] * 8;
+    block_end_bit_ = block_offsets_[block + 1] * 8;
+    return true;
+}
+
+bool SessionArchiveReader::Next(ArchivedSession& session) {
+    if (next_ >= sessions_ || (next_ % sessions_per_block_ == 0 && !StartBlock(next_ / sessions_per_block_))) {
+        return false;
+    }
+    std::size_t bit = bit_;
+    if (!DecodeSession(data_.data(), bit, block_end_bit_, session)) {
+        // Stay on the damaged session rather than decode garbage after it.
+        return false;
+    }
+    bit_ = bit;
+    ++next_;
+    return true;
+}
+
+bool SessionArchiveReader::Seek(const std::uint64_t index) {
+    if (index >= sessions_ || !StartBlock(index / sessions_per_block_)) {
+        return false;
+    }
+    while (next_ < index) {
+        if (!Next(skipped_)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SessionArchiveReader::DecodeBlock(const std::uint64_t block, std::vector<ArchivedSession>& sessions) const {
+    if (block >= block_count()) {
+        return false;
+    }
+    const std::uint64_t first = block * sessions_per_block_;
+    sessions.resize(static_cast<std::size_t>(std::min(sessions_per_block_, sessions_ - first)));
+    std::size_t bit = block_offsets_[block] * 8;
+    const std::size_t end_bit = block_offsets_[block + 1] * 8;
+    return std::all_of(sessions.begin(), sessions.end(), [&](ArchivedSession& session) {
+        return DecodeSession(data_.data(), bit, end_bit, session);
+    });
+}
+
+bool SessionArchiveReader::Read(const std::uint64_t index, ArchivedSession& session) {
+    return Seek(index) && Next(session);
+}
@@ -0,0 +1,119 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../game/game_engine.h"
+#include "../game_state/game_state.h"
+#include "replay_log.h"
+
+// One year of an archived session: the decision, what the year brought and the city it left.
+struct ArchivedYear {
+    UserInputData decision;
+    // Years follow each other and share the session's seed: the year and seed of the state, the
+    // year of the events and the harvest are derived on reading rather than stored.
+    YearEvents events;
+    GameState state{0};
+};
+
+// A whole session: the city it started from (with its seed), the land price of its first year, what
+// a resumed game carries over from the year before it and every year played.
+struct ArchivedSession {
+    GameState initial_state{0};
+    int initial_land_price = 0;
+    // All zero for a new game.
+    int initial_starvation_deaths = 0;
+    int initial_new_citizens = 0;
+    int initial_total_starvation_deaths = 0;
+    std::vector<ArchivedYear> years;
+
+    // Starts the session from the engine as it stands before its first decision.
+    void Begin(const GameEngine& engine);
+    // Appends the year PlayYear(decision) has just resolved on `engine`.
+    void AddYear(const UserInputData& decision, const YearEvents& events, const GameEngine& engine);
+};
+
+// Plays the session's decisions again from its starting engine.
+GameEngine ReplayArchived(const ArchivedSession& session);
+// Re-simulates a replay log session into an archived one; false if it does not replay cleanly.
+bool ArchiveReplay(const ReplaySession& session, ArchivedSession& archived);
+
+// Writes finished sessions to a compressed archive.
+//
+// Sessions are bit-packed, each from a byte boundary, in blocks of kSessionsPerBlock. Every field
+// of a year is stored as its difference from a prediction, in Exp-Golomb codes: decisions from the
+// year before, the grain eaten from what feeds everyone, and the draws and the city from what the
+// stock rules make of the seed and the previous year. A year that went by the stock rules thus
+// costs one bit beyond its decision, about 40 bits in all for a trading strategy; other rules
+// still round-trip, with the draws and corrections written out. The file ends with the offset of
+// every block, so a single session is read by decoding at most one block.
+class SessionArchiveWriter {
+ public:
+    static constexpr std::size_t kSessionsPerBlock = 64;
+
+    SessionArchiveWriter() = default;
+    ~SessionArchiveWriter();
+    SessionArchiveWriter(const SessionArchiveWriter&) = delete;
+    SessionArchiveWriter& operator=(const SessionArchiveWriter&) = delete;
+
+    // Creates or truncates the archive; false if it cannot be written.
+    bool Open(const std::string& path);
+    bool Add(const ArchivedSession& session);
+    // Writes the last block and the index. The archive is not readable until it is closed.
+    bool Close();
+
+    [[nodiscard]] std::uint64_t size() const { return sessions_; }
+
+ private:
+    bool WriteBlock();
+
+    std::FILE* file_ = nullptr;
+    // Where the next block goes in the file.
+    std::uint64_t offset_ = 0;
+    std::uint64_t sessions_ = 0;
+    std::vector<unsigned char> block_;
+    std::vector<std::uint64_t> block_offsets_;
+};
+
+// Reads a whole archive into memory and decodes sessions in order or by index.
+class SessionArchiveReader {
+ public:
+    // False if the file is missing, is not an archive or its index is damaged.
+    bool Open(const std::string& path);
+
+    [[nodiscard]] std::uint64_t size() const { return sessions_; }
+    // The next session in order; false at the end or on a damaged block.
+    bool Next(ArchivedSession& session);
+    // Session `index`, decoding only its block; false if out of range or damaged.
+    bool Read(std::uint64_t index, ArchivedSession& session);
+    // Moves Next() to session `index`.
+    bool Seek(std::uint64_t index);
+
+    // Blocks decode independently, so threads streaming through an archive can take a block each.
+    [[nodiscard]] std::uint64_t block_count() const { return block_offsets_.empty() ? 0 : block_offsets_.size() - 1; }
+    // Replaces `sessions` with the sessions of `block`; safe to call from several threads at once.
+    bool DecodeBlock(std::uint64_t block, std::vector<ArchivedSession>& sessions) const;
+
+    // Bytes of the archive file.
+    [[nodiscard]] std::size_t byte_size() const { return file_size_; }
+
+ private:
+    bool StartBlock(std::uint64_t block);
+
+    std::vector<unsigned char> data_;
+    std::size_t file_size_ = 0;
+    // Every block's offset, then the end of the last block.
+    std::vector<std::uint64_t> block_offsets_;
+    std::uint64_t sessions_ = 0;
+    std::uint64_t sessions_per_block_ = 0;
+    ArchivedSession skipped_;
+    // Next() position: the session it returns next and the bit it starts at.
+    std::uint64_t next_ = 0;
+    std::size_t bit_ = 0;
+    std::size_t block_end_bit_ = 0;
+};
@@ -0,0 +1,141 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include "year_trace.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <string_view>
+
+namespace {
+
+constexpr char kMagic[4] = {'H', 'M', 'T', 'R'};
+constexpr std::uint32_t kVersion = 1;
+// Most characters std::to_chars writes for a T, sign included.
+template<typename T>
+constexpr std::size_t kMaxChars = std::numeric_limits<T>::digits10 + 1 + (std::numeric_limits<T>::is_signed ? 1 : 0);
+// Longest CSV row: every column at its widest, as a damaged binary trace may hold any value, and
+// the separators.
+constexpr std::size_t kMaxCsvRow = kMaxChars<std::uint64_t> + 6 * kMaxChars<std::int32_t> + kMaxChars<std::uint8_t> + 8;
+// Bounds what a damaged header can make ReadBinary allocate.
+constexpr std::uint64_t kMaxBlockRows = std::uint64_t{1} << 28;
+
+struct BlockHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t rows;
+};
+
+template<typename T>
+void AppendColumn(std::vector<char>& buffer, const std::vector<T>& column) {
+    const auto* bytes = reinterpret_cast<const char*>(column.data());
+    buffer.insert(buffer.end(), bytes, bytes + column.size() * sizeof(T));
+}
+
+template<typename T>
+bool ReadColumn(std::FILE* file, std::vector<T>& column, const std::size_t rows) {
+    column.resize(rows);
+    return std::fread(column.data(), sizeof(T), rows, file) == rows;
+}
+
+// Writes `value` and `separator` if they fit before `end`; returns where the next number goes, which
+// is `end` once the buffer is full.
+template<typename T>
+char* AppendNumber(char* out, char* const end, const T value, const char separator) {
+    const auto [next, error] = std::to_chars(out, end, value);
+    if (error != std::errc() || next == end) {
+        return end;
+    }
+    *next = separator;
+    return next + 1;
+}
+
+bool WriteAll(std::FILE* file, const std::vector<char>& buffer) {
+    return std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+}
+
+}  // namespace
+
+void YearTrace::Reserve(const std::size_t rows) {
+    seed.reserve(rows);
+    year.reserve(rows);
+    harvest.reserve(rows);
+    rats_ate.reserve(rows);
+    plague.reserve(rows);
+    starvation_deaths.reserve(rows);
+    new_citizens.reserve(rows);
+    land_price.reserve(rows);
+}
+
+void YearTrace::Clear() {
+    seed.clear();
+    year.clear();
+    harvest.clear();
+    rats_ate.clear();
+    plague.clear();
+    starvation_deaths.clear();
+    new_citizens.clear();
+    land_price.clear();
+}
+
+bool YearTrace::WriteBinary(std::FILE* file) const {
+    BlockHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.rows = size();
+
+    std::vector<char> buffer;
+    buffer.reserve(sizeof(header) + size() * (sizeof(std::uint64_t) + sizeof(std::uint8_t) + 6 * sizeof(std::int32_t)));
+    const auto* header_bytes = reinterpret_cast<const char*>(&header);
+    buffer.insert(buffer.end(), header_bytes, header_bytes + sizeof(header));
+    AppendColumn(buffer, seed);
+    AppendColumn(buffer, year);
+    AppendColumn(buffer, harvest);
+    AppendColumn(buffer, rats_ate);
+    AppendColumn(buffer, plague);
+    AppendColumn(buffer, starvation_deaths);
+    AppendColumn(buffer, new_citizens);
+    AppendColumn(buffer, land_price);
+    return WriteAll(file, buffer);
+}
+
+bool YearTrace::WriteCsv(std::FILE* file, const bool header) const {
+    constexpr std::string_view kHeader = "seed,year,harvest,rats_ate,plague,starvation_deaths,new_citizens,land_price\n";
+    std::vector<char> buffer((header ? kHeader.size() : 0) + size() * kMaxCsvRow);
+    char* out = buffer.data();
+    char* const end = buffer.data() + buffer.size();
+    if (header) {
+        out = std::copy(kHeader.begin(), kHeader.end(), out);
+    }
+    for (std::size_t row = 0; row < size(); ++row) {
+        out = AppendNumber(out, end, seed[row], ',');
+        out = AppendNumber(out, end, year[row], ',');
+        out = AppendNumber(out, end, harvest[row], ',');
+        out = AppendNumber(out, end, rats_ate[row], ',');
+        out = AppendNumber(out, end, plague[row], ',');
+        out = AppendNumber(out, end, starvation_deaths[row], ',');
+        out = AppendNumber(out, end, new_citizens[row], ',');
+        out = AppendNumber(out, end, land_price[row], '\n');
+    }
+    buffer.resize(out - buffer.data());
+    return WriteAll(file, buffer);
+}
+
+bool YearTrace::ReadBinary(std::FILE* file) {
+    Clear();
+    BlockHeader header{};
+    if (std::fread(&header, sizeof(header), 1, file) != 1 || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kVersion || header.rows > kMaxBlockRows) {
+        return false;
+    }
+    const auto rows = static_cast<std::size_t>(header.rows);
+    if (!ReadColumn(file, seed, rows) || !ReadColumn(file, year, rows) || !ReadColumn(file, harvest, rows) ||
+        !ReadColumn(file, rats_ate, rows) || !ReadColumn(file, plague, rows) ||
+        !ReadColumn(file, starvation_deaths, rows) || !ReadColumn(file, new_citizens, rows) ||
+        !ReadColumn(file, land_price, rows)) {
+        Clear();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,54 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// Year-by-year events of many games, one column per field. GameEngine appends a row for every
+// year it resolves while a trace is attached (see GameEngine::SetTrace). A whole trace is
+// exported at once: it is laid out in a single buffer and handed to the file in one write, so a
+// batch simulation can trace millions of games and flush them batch by batch.
+//
+// The binary format is a sequence of blocks. Each block is a header (magic "HMTR", version, row
+// count) followed by the columns in the order below, each stored contiguously in host byte
+// order: seed as uint64, plague as uint8, the other columns as int32.
+class YearTrace {
+ public:
+    std::vector<std::uint64_t> seed;
+    std::vector<std::int32_t> year;
+    std::vector<std::int32_t> harvest;
+    std::vector<std::int32_t> rats_ate;
+    std::vector<std::uint8_t> plague;
+    std::vector<std::int32_t> starvation_deaths;
+    std::vector<std::int32_t> new_citizens;
+    // The price of land during that year.
+    std::vector<std::int32_t> land_price;
+
+    void Record(std::uint64_t game_seed, int game_year, int year_harvest, int year_rats_ate, bool year_plague,
+                int year_starvation_deaths, int year_new_citizens, int year_land_price);
+    void Reserve(std::size_t rows);
+    void Clear();
+    [[nodiscard]] std::size_t size() const { return seed.size(); }
+
+    // Append the whole trace to `file` as one binary block or as CSV rows; false on a write error.
+    bool WriteBinary(std::FILE* file) const;
+    bool WriteCsv(std::FILE* file, bool header) const;
+    // Replaces the trace with the next binary block of `file`; false at the end or on a damaged block.
+    bool ReadBinary(std::FILE* file);
+};
+
+inline void YearTrace::Record(const std::uint64_t game_seed, const int game_year, const int year_harvest,
+                              const int year_rats_ate, const bool year_plague, const int year_starvation_deaths,
+                              const int year_new_citizens, const int year_land_price) {
+    seed.push_back(game_seed);
+    year.push_back(game_year);
+    harvest.push_back(year_harvest);
+    rats_ate.push_back(year_rats_ate);
+    plague.push_back(year_plague ? 1 : 0);
+    starvation_deaths.push_back(year_starvation_deaths);
+    new_citizens.push_back(year_new_citizens);
+    land_price.push_back(year_land_price);
+}
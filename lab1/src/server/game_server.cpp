@@ -0,0 +1,304 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include "game_server.h"
+
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../file_system/file_manager.h"
+#include "../game/game.h"
+#include "../game/game_io.h"
+
+namespace {
+
+constexpr char kPlayerPrompt[] = "Введите номер игрока: ";
+constexpr char kLoadPrompt[] = "Хотите загрузить сохраненную игру? (y/n): ";
+constexpr int kMaxEvents = 256;
+
+bool ParsePlayerId(std::string_view text, std::uint64_t& player_id) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+        text.remove_suffix(1);
+    }
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), player_id);
+    return error == std::errc() && end == text.data() + text.size() && player_id != 0;
+}
+
+}  // namespace
+
+struct GameServer::Session {
+    enum class Stage : std::uint8_t { kPlayerId, kLoad, kPlaying };
+
+    // Created once the player has chosen between a new game and the save, so a session that is still
+    // asking holds no coroutine frame.
+    std::optional<Game> game;
+    std::uint64_t player_id = 0;
+    // The unfinished line received so far and the reply not yet sent.
+    std::string input;
+    std::string output;
+    Stage stage = Stage::kPlayerId;
+    // The connection is done: it is closed once the output has been sent.
+    bool closing = false;
+    // What the socket is registered with epoll for.
+    std::uint32_t polled_events = EPOLLIN | EPOLLRDHUP;
+};
+
+GameServer::GameServer(std::string socket_path): socket_path_(std::move(socket_path)) {}
+
+GameServer::~GameServer() {
+    for (const int fd : {wake_fd_, epoll_fd_, listen_fd_}) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+    if (listen_fd_ >= 0) {
+        unlink(socket_path_.c_str());
+    }
+}
+
+bool GameServer::Open() {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path_.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    socket_path_.copy(address.sun_path, socket_path_.size());
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (listen_fd_ < 0 || epoll_fd_ < 0 || wake_fd_ < 0) {
+        return false;
+    }
+    unlink(socket_path_.c_str());
+    if (bind(listen_fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listen_fd_, SOMAXCONN) != 0) {
+        return false;
+    }
+    for (const int fd : {listen_fd_, wake_fd_}) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void GameServer::Stop() {
+    stopping_.store(true);
+    if (wake_fd_ >= 0) {
+        const std::uint64_t one = 1;
+        [[maybe_unused]] const ssize_t written = write(wake_fd_, &one, sizeof(one));
+    }
+}
+
+bool GameServer::Run() {
+    if (epoll_fd_ < 0) {
+        return false;
+    }
+    GameIO::SetOutput(&output_);
+    bool polled = true;
+    epoll_event events[kMaxEvents];
+    while (!stopping_.load()) {
+        const int count = epoll_wait(epoll_fd_, events, kMaxEvents, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            polled = false;
+            break;
+        }
+        for (int i = 0; i < count; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == listen_fd_) {
+                Accept();
+                continue;
+            }
+            if (fd == wake_fd_ || sessions_[fd] == nullptr) {
+                continue;
+            }
+            Session& session = *sessions_[fd];
+            if (!session.closing && (events[i].events & ~EPOLLOUT) != 0) {
+                Receive(fd);
+            }
+            if (!Send(fd, session)) {
+                Close(fd);
+            }
+        }
+    }
+    for (std::size_t fd = 0; fd < sessions_.size(); ++fd) {
+        if (sessions_[fd] != nullptr) {
+            Close(static_cast<int>(fd));
+        }
+    }
+    FileManager::FlushPlayerSaves();
+    GameIO::SetOutput(nullptr);
+    return polled;
+}
+
+void GameServer::Accept() {
+    while (true) {
+        const int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno == EMFILE || errno == ENFILE) {
+                // Out of descriptors: stop listening until a session ends, instead of spinning.
+                epoll_event event{};
+                event.data.fd = listen_fd_;
+                listening_ = epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, listen_fd_, &event) != 0;
+            }
+            return;
+        }
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            continue;
+        }
+        if (static_cast<std::size_t>(fd) >= sessions_.size()) {
+            sessions_.resize(fd + 1);
+        }
+        sessions_[fd] = std::make_unique<Session>();
+        ++session_count_;
+        output_.SetTarget(&sessions_[fd]->output);
+        GameIO::Output().Write(kPlayerPrompt);
+        if (!Send(fd, *sessions_[fd])) {
+            Close(fd);
+        }
+    }
+}
+
+void GameServer::Receive(const int fd) {
+    Session& session = *sessions_[fd];
+    output_.SetTarget(&session.output);
+    char buffer[4096];
+    while (!session.closing) {
+        const ssize_t count = recv(fd, buffer, sizeof(buffer), 0);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            session.closing = errno != EAGAIN && errno != EWOULDBLOCK;
+            return;
+        }
+        if (count == 0) {
+            // The client may only have shut down its side; it still gets the replies.
+            session.closing = true;
+            return;
+        }
+        session.input.append(buffer, static_cast<std::size_t>(count));
+        std::size_t begin = 0;
+        for (std::size_t end = session.input.find('\n'); end != std::string::npos && !session.closing;
+             end = session.input.find('\n', begin)) {
+            std::string_view line(session.input.data() + begin, end - begin);
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            HandleLine(session, line);
+            begin = end + 1;
+        }
+        session.input.erase(0, begin);
+        if (session.input.size() > kMaxLineLength) {
+            session.closing = true;
+        }
+    }
+}
+
+void GameServer::HandleLine(Session& session, const std::string_view line) {
+    switch (session.stage) {
+        case Session::Stage::kPlayerId:
+            if (!ParsePlayerId(line, session.player_id)) {
+                GameIO::PrintMessage("Ошибка: введите целое число больше 0.");
+                GameIO::Output().Write(kPlayerPrompt);
+                return;
+            }
+            if (FileManager::IsSaveFileExists(session.player_id)) {
+                session.stage = Session::Stage::kLoad;
+                GameIO::Output().Write(kLoadPrompt);
+                return;
+            }
+            session.game.emplace(GameEngine());
+            break;
+        case Session::Stage::kLoad:
+            session.game.emplace(GameIO::IsYes(line) ? FileManager::TryLoadGame(session.player_id) : GameEngine());
+            break;
+        case Session::Stage::kPlaying:
+            session.game->Answer(line);
+            session.closing = session.game->IsOver();
+            return;
+    }
+    session.game->SetPlayer(session.player_id);
+    session.game->SetLeaderboard(leaderboard_);
+    session.game->SetJournal(journal_);
+    session.stage = Session::Stage::kPlaying;
+    session.game->Begin();
+    session.closing = session.game->IsOver();
+}
+
+bool GameServer::Send(const int fd, Session& session) {
+    output_.SetTarget(&session.output);
+    std::size_t sent = 0;
+    while (sent < session.output.size()) {
+        const ssize_t count = send(fd, session.output.data() + sent, session.output.size() - sent, MSG_NOSIGNAL);
+        if (count >= 0) {
+            sent += static_cast<std::size_t>(count);
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else if (errno != EINTR) {
+            return false;
+        }
+    }
+    session.output.erase(0, sent);
+    const bool waiting = !session.output.empty();
+    // A closing session reads nothing more, and a socket the client has shut down stays readable,
+    // so it only waits to be writable: polling for input as well would wake the loop without end.
+    const std::uint32_t polled_events = session.closing ? EPOLLOUT
+                                                        : EPOLLIN | EPOLLRDHUP | (waiting ? EPOLLOUT : 0u);
+    // A closing session with nothing left to send is about to be closed.
+    if ((waiting || !session.closing) && polled_events != session.polled_events) {
+        epoll_event event{};
+        event.events = polled_events;
+        event.data.fd = fd;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event);
+        session.polled_events = polled_events;
+    }
+    if (waiting) {
+        return true;
+    }
+    // Idle sessions should not hold on to their last reply.
+    std::string().swap(session.output);
+    return !session.closing;
+}
+
+void GameServer::Close(const int fd) {
+    Session& session = *sessions_[fd];
+    if (session.stage == Session::Stage::kPlaying && !session.game->IsOver()) {
+        session.game->Save();
+    }
+    output_.SetTarget(nullptr);
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    sessions_[fd].reset();
+    --session_count_;
+    if (!listening_) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = listen_fd_;
+        listening_ = epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, listen_fd_, &event) == 0;
+    }
+}
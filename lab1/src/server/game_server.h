@@ -0,0 +1,72 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../io/output_sink.h"
+
+class AutosaveJournal;
+class Leaderboard;
+
+// Hosts many games in one thread on a Unix domain socket (Linux only). Every connection is a
+// session: the client sends its player id, is offered its save if it has one, and then plays
+// Game one line at a time. Sockets are non-blocking and multiplexed with epoll, and a session
+// only keeps its Game and whatever part of a line or a reply is in flight, so an idle session
+// costs a few hundred bytes.
+//
+// Games are saved with FileManager in the player's slot when the player asks to, when the
+// connection drops in the middle of a game, and for every game still running at Stop().
+class GameServer {
+ public:
+    explicit GameServer(std::string socket_path);
+    ~GameServer();
+    GameServer(const GameServer&) = delete;
+    GameServer& operator=(const GameServer&) = delete;
+
+    // Creates the socket, replacing a stale one at the same path.
+    bool Open();
+    // Serves sessions until Stop(); false if the server is not open or polling fails.
+    bool Run();
+    // Safe to call from another thread or a signal handler.
+    void Stop();
+    // Finished reigns of every session are recorded on `leaderboard`, which the server does not own.
+    void SetLeaderboard(Leaderboard* leaderboard) { leaderboard_ = leaderboard; }
+    // Every session's game is journaled to `journal`, which the server does not own.
+    void SetJournal(AutosaveJournal* journal) { journal_ = journal; }
+
+    [[nodiscard]] std::size_t session_count() const { return session_count_; }
+
+ private:
+    struct Session;
+
+    static constexpr std::size_t kMaxLineLength = 1024;
+
+    std::string socket_path_;
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    std::atomic<bool> stopping_ = false;
+    // Off while the process is out of descriptors.
+    bool listening_ = true;
+    // Indexed by socket descriptor, which the kernel keeps dense.
+    std::vector<std::unique_ptr<Session>> sessions_;
+    std::size_t session_count_ = 0;
+    // Shared by all sessions and pointed at the one being served.
+    StringSink output_;
+    Leaderboard* leaderboard_ = nullptr;
+    AutosaveJournal* journal_ = nullptr;
+
+    void Accept();
+    void Receive(int fd);
+    void HandleLine(Session& session, std::string_view line);
+    // Sends what the session has to say; false if the connection has to be closed.
+    bool Send(int fd, Session& session);
+    // Saves a game left unfinished.
+    void Close(int fd);
+};
@@ -0,0 +1,516 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include "city_batch.h"
+
+#include <algorithm>
+
+#include "../utils/random.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define HAMMURABI_AVX2 1
+#include <immintrin.h>
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+// Columns are padded to whole blocks of eight int32; padding cities start with their game over.
+constexpr std::size_t kLanes = 8;
+constexpr std::uint64_t kGoldenGamma = 0x9E3779B97F4A7C15ull;
+
+CityBatch::CityBatch(): size_(0), playing_(0), vectorized_(IsVectorizationSupported()), rules_(nullptr) {}
+
+CityBatch::CityBatch(const std::uint64_t seed, const std::uint64_t first_game, const std::size_t count,
+                     const Ruleset* rules): CityBatch() {
+    Reset(seed, first_game, count, rules);
+}
+
+void CityBatch::Reset(const std::uint64_t seed, const std::uint64_t first_game, const std::size_t count,
+                      const Ruleset* rules) {
+    rules_ = rules;
+    const Ruleset& initial = rules != nullptr ? *rules : kDefaultRuleset;
+    const std::size_t padded = (count + kLanes - 1) / kLanes * kLanes;
+    for (auto* column : {&year_, &population_, &acres_, &wheat_, &starvation_deaths_, &new_citizens_, &plague_,
+                         &wheat_per_acre_, &rats_ate_, &land_price_, &total_starvation_deaths_,
+                         &acres_to_buy_, &acres_to_sell_, &wheat_to_plant_, &wheat_to_eat_}) {
+        column->assign(padded, 0);
+    }
+    game_over_.assign(padded, -1);
+    seed_.assign(padded, 0);
+    mixed_seed_.assign(padded, 0);
+
+    for (std::size_t city = 0; city < count; ++city) {
+        const GameState state(seed ^ SplitMix64(first_game + city), initial);
+        year_[city] = state.year_;
+        population_[city] = state.population_;
+        acres_[city] = state.acres_;
+        wheat_[city] = state.wheat_;
+        seed_[city] = state.seed_;
+        mixed_seed_[city] = SplitMix64(state.seed_);
+        game_over_[city] = 0;
+    }
+    size_ = count;
+    playing_ = count;
+}
+
+bool CityBatch::IsVectorizationSupported() {
+#ifdef HAMMURABI_AVX2
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+void CityBatch::SetVectorized(const bool vectorized) {
+    vectorized_ = vectorized && IsVectorizationSupported();
+}
+
+GameState CityBatch::game_state(const std::size_t city) const {
+    GameState state(seed_[city]);
+    state.year_ = year_[city];
+    state.population_ = population_[city];
+    state.acres_ = acres_[city];
+    state.wheat_ = wheat_[city];
+    return state;
+}
+
+YearState CityBatch::year_state(const std::size_t city) const {
+    return {starvation_deaths_[city], new_citizens_[city], plague_[city] != 0, wheat_per_acre_[city],
+            rats_ate_[city], land_price_[city], total_starvation_deaths_[city]};
+}
+
+void CityBatch::GenerateRandomParams() {
+#ifdef HAMMURABI_AVX2
+    if (vectorized_) {
+        for (std::size_t first = 0; first < game_over_.size(); first += kLanes) {
+            GenerateRandomParamsAvx2(first);
+        }
+        return;
+    }
+#endif
+    for (std::size_t city = 0; city < size_; ++city) {
+        if (game_over_[city] == 0) {
+            GenerateRandomParams(city);
+        }
+    }
+}
+
+void CityBatch::ClampDecisions(const UserInputData& policy) {
+#ifdef HAMMURABI_AVX2
+    if (vectorized_) {
+        for (std::size_t first = 0; first < game_over_.size(); first += kLanes) {
+            ClampDecisionsAvx2(first, policy);
+        }
+        return;
+    }
+#endif
+    for (std::size_t city = 0; city < size_; ++city) {
+        if (game_over_[city] == 0) {
+            ClampDecision(city, policy);
+        }
+    }
+}
+
+void CityBatch::SetDecision(const std::size_t city, const UserInputData& decision) {
+    acres_to_buy_[city] = decision.acres_to_buy;
+    acres_to_sell_[city] = decision.acres_to_sell;
+    wheat_to_plant_[city] = decision.wheat_to_plant;
+    wheat_to_eat_[city] = decision.wheat_to_eat;
+}
+
+void CityBatch::UpdateCityState() {
+#ifdef HAMMURABI_AVX2
+    if (vectorized_) {
+        for (std::size_t first = 0; first < game_over_.size(); first += kLanes) {
+            UpdateCityStateAvx2(first);
+        }
+        return;
+    }
+#endif
+    for (std::size_t city = 0; city < size_; ++city) {
+        if (game_over_[city] == 0) {
+            UpdateCityState(city);
+        }
+    }
+}
+
+void CityBatch::NextYear() {
+#ifdef HAMMURABI_AVX2
+    if (vectorized_) {
+        for (std::size_t first = 0; first < game_over_.size(); first += kLanes) {
+            ResolveYearAvx2(first);
+            GenerateRandomParamsAvx2(first);
+        }
+        CountPlaying();
+        return;
+    }
+#endif
+    for (std::size_t city = 0; city < size_; ++city) {
+        if (game_over_[city] == 0) {
+            ResolveYear(city);
+            if (game_over_[city] == 0) {
+                GenerateRandomParams(city);
+            }
+        }
+    }
+    CountPlaying();
+}
+
+void CityBatch::PlayYear(const UserInputData& policy) {
+#ifdef HAMMURABI_AVX2
+    if (vectorized_) {
+        for (std::size_t first = 0; first < game_over_.size(); first += kLanes) {
+            ClampDecisionsAvx2(first, policy);
+            UpdateCityStateAvx2(first);
+            ResolveYearAvx2(first);
+            GenerateRandomParamsAvx2(first);
+        }
+        CountPlaying();
+        return;
+    }
+#endif
+    for (std::size_t city = 0; city < size_; ++city) {
+        if (game_over_[city] == 0) {
+            ClampDecision(city, policy);
+            UpdateCityState(city);
+            ResolveYear(city);
+            if (game_over_[city] == 0) {
+                GenerateRandomParams(city);
+            }
+        }
+    }
+    CountPlaying();
+}
+
+void CityBatch::PlayReign(const UserInputData& policy) {
+    GenerateRandomParams();
+    while (playing_ > 0) {
+        PlayYear(policy);
+    }
+}
+
+void CityBatch::CountPlaying() {
+    playing_ = static_cast<std::size_t>(std::count(game_over_.begin(), game_over_.end(), 0));
+}
+
+void CityBatch::GenerateRandomParams(const std::size_t city) {
+    // Same stream and draw order as GameEngine::GenerateRandomParams.
+    WithRules(rules_, [this, city](const auto& rules) {
+        Random random(mixed_seed_[city] ^ static_cast<std::uint64_t>(year_[city]));
+        plague_[city] = random.NextInRange(0, rules.plague_roll_max) < rules.plague_chance;
+        wheat_per_acre_[city] = random.NextInRange(rules.min_wheat_per_acre, rules.max_wheat_per_acre);
+        rats_ate_[city] =
+            random.NextInRange(0, std::max(0, static_cast<int>(wheat_[city] * rules.rats_wheat_consumption_fraction)));
+        land_price_[city] = random.NextInRange(rules.min_land_price, rules.max_land_price);
+    });
+}
+
+void CityBatch::ClampDecision(const std::size_t city, const UserInputData& policy) {
+    const int price = land_price_[city];
+    const int wheat = wheat_[city];
+    const int acres_to_buy = std::clamp(policy.acres_to_buy, 0, std::max(0, wheat / price));
+    const int acres_to_sell = std::clamp(policy.acres_to_sell, 0, acres_[city]);
+    const int wheat_to_plant = std::clamp(policy.wheat_to_plant, 0, std::max(0, wheat));
+    const int wheat_remaining = wheat - acres_to_buy * price + acres_to_sell * price - wheat_to_plant;
+    acres_to_buy_[city] = acres_to_buy;
+    acres_to_sell_[city] = acres_to_sell;
+    wheat_to_plant_[city] = wheat_to_plant;
+    wheat_to_eat_[city] = std::clamp(policy.wheat_to_eat, 0, std::max(0, wheat_remaining));
+}
+
+void CityBatch::UpdateCityState(const std::size_t city) {
+    acres_[city] += acres_to_buy_[city] - acres_to_sell_[city];
+    wheat_[city] -= wheat_to_eat_[city] + wheat_to_plant_[city];
+    wheat_[city] += acres_to_sell_[city] * wheat_per_acre_[city];
+    const int fed = WithRules(rules_, [this, city](const auto& rules) {
+        return wheat_to_eat_[city] / rules.wheat_per_person;
+    });
+    starvation_deaths_[city] = std::max(0, population_[city] - fed);
+}
+
+void CityBatch::ResolveYear(const std::size_t city) {
+    const int year = ++year_[city];
+    const int total_wheat = acres_[city] * wheat_per_acre_[city] - rats_ate_[city];
+    wheat_[city] += total_wheat;
+
+    int population = plague_[city] ? population_[city] / 2 : population_[city];
+    const int starvation_deaths = starvation_deaths_[city];
+    population -= starvation_deaths;
+    total_starvation_deaths_[city] += starvation_deaths;
+    const int new_citizens = std::max(0, std::min(50, starvation_deaths / 2 +
+                                                      (5 - wheat_per_acre_[city]) * total_wheat / 600 + 1));
+    new_citizens_[city] = new_citizens;
+    population += new_citizens;
+    population_[city] = population;
+
+    const bool game_over = WithRules(rules_, [=](const auto& rules) {
+        return starvation_deaths > rules.max_starvation_deaths * population || population == 0 ||
+               year >= rules.max_years;
+    });
+    if (game_over) {
+        game_over_[city] = -1;
+    }
+}
+
+#ifdef HAMMURABI_AVX2
+
+namespace {
+
+// Moves the high half of every 64-bit lane into its low half, which is what _mm256_mul_epu32 reads.
+AVX2_TARGET inline __m256i High32(const __m256i x) {
+    return _mm256_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 1, 1));
+}
+
+// 64x64-bit multiplication (low half) from AVX2's 32x32 -> 64-bit multiplies.
+AVX2_TARGET inline __m256i Mul64(const __m256i a, const __m256i b) {
+    const __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(a, High32(b)), _mm256_mul_epu32(High32(a), b));
+    return _mm256_add_epi64(_mm256_mul_epu32(a, b), _mm256_slli_epi64(cross, 32));
+}
+
+template<int K>
+AVX2_TARGET inline __m256i Rotl64(const __m256i x) {
+    return _mm256_or_si256(_mm256_slli_epi64(x, K), _mm256_srli_epi64(x, 64 - K));
+}
+
+AVX2_TARGET inline __m256i SplitMix64x4(__m256i x) {
+    x = _mm256_add_epi64(x, _mm256_set1_epi64x(static_cast<long long>(kGoldenGamma)));
+    x = Mul64(_mm256_xor_si256(x, _mm256_srli_epi64(x, 30)), _mm256_set1_epi64x(0xBF58476D1CE4E5B9ll));
+    x = Mul64(_mm256_xor_si256(x, _mm256_srli_epi64(x, 27)), _mm256_set1_epi64x(0x94D049BB133111EBll));
+    return _mm256_xor_si256(x, _mm256_srli_epi64(x, 31));
+}
+
+// Low and high halves of the 64-bit lanes, packed into four int32.
+AVX2_TARGET inline __m128i Low32x4(const __m256i x) {
+    return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+}
+
+AVX2_TARGET inline __m128i High32x4(const __m256i x) {
+    return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(1, 3, 5, 7, 1, 3, 5, 7)));
+}
+
+// Four Random generators side by side, one per 64-bit lane.
+struct RandomX4 {
+    __m256i state[4];
+
+    AVX2_TARGET explicit RandomX4(__m256i seed) {
+        for (__m256i& word : state) {
+            seed = _mm256_add_epi64(seed, _mm256_set1_epi64x(static_cast<long long>(kGoldenGamma)));
+            word = SplitMix64x4(seed);
+        }
+    }
+
+    AVX2_TARGET __m256i Next() {
+        // x * 5 and x * 9 as additions: the shift ports are the bottleneck here.
+        const __m256i twice = _mm256_add_epi64(state[1], state[1]);
+        const __m256i rotated = Rotl64<7>(_mm256_add_epi64(_mm256_add_epi64(twice, twice), state[1]));
+        const __m256i rotated2 = _mm256_add_epi64(rotated, rotated);
+        const __m256i rotated4 = _mm256_add_epi64(rotated2, rotated2);
+        const __m256i result = _mm256_add_epi64(_mm256_add_epi64(rotated4, rotated4), rotated);
+        const __m256i t = _mm256_slli_epi64(state[1], 17);
+        state[2] = _mm256_xor_si256(state[2], state[0]);
+        state[3] = _mm256_xor_si256(state[3], state[1]);
+        state[1] = _mm256_xor_si256(state[1], state[2]);
+        state[0] = _mm256_xor_si256(state[0], state[3]);
+        state[2] = _mm256_xor_si256(state[2], t);
+        state[3] = Rotl64<45>(state[3]);
+        return result;
+    }
+
+    // Random::NextInRange without the rejection loop; lanes that might need it (or have an empty
+    // 32-bit range) are flagged in `redo` and must be drawn again with Random.
+    AVX2_TARGET __m128i NextInRange(const int min, const __m256i range, __m256i& redo) {
+        const __m256i product = _mm256_mul_epu32(High32(Next()), range);
+        const __m256i low = _mm256_and_si256(product, _mm256_set1_epi64x(0xFFFFFFFFll));
+        redo = _mm256_or_si256(redo, _mm256_or_si256(_mm256_cmpgt_epi64(range, low),
+                                                     _mm256_cmpeq_epi64(range, _mm256_setzero_si256())));
+        return _mm_add_epi32(_mm_set1_epi32(min), High32x4(product));
+    }
+};
+
+AVX2_TARGET inline __m256i Load8(const std::int32_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+AVX2_TARGET inline void Store8(std::int32_t* p, const __m256i x) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x);
+}
+
+// Stores `x` into the lanes whose `keep` mask is clear.
+AVX2_TARGET inline void StoreUnless(std::int32_t* p, const __m256i x, const __m256i keep) {
+    Store8(p, _mm256_blendv_epi8(x, Load8(p), keep));
+}
+
+AVX2_TARGET inline bool AllSet(const __m256i mask) {
+    return _mm256_movemask_ps(_mm256_castsi256_ps(mask)) == 0xFF;
+}
+
+// Truncating int32 division, exact because every int32 quotient is exact in double.
+AVX2_TARGET inline __m256i Divide(const __m256i x, const __m256i divisor) {
+    const __m128i low = _mm256_cvttpd_epi32(_mm256_div_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(x)),
+                                                          _mm256_cvtepi32_pd(_mm256_castsi256_si128(divisor))));
+    const __m128i high = _mm256_cvttpd_epi32(_mm256_div_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(x, 1)),
+                                                           _mm256_cvtepi32_pd(_mm256_extracti128_si256(divisor, 1))));
+    return _mm256_set_m128i(high, low);
+}
+
+AVX2_TARGET inline __m256i Halve(const __m256i x) {
+    return _mm256_srai_epi32(_mm256_add_epi32(x, _mm256_srli_epi32(x, 31)), 1);
+}
+
+// deaths > max_share * population, compared in double like GameEngine::IsGameOver.
+AVX2_TARGET inline __m256i TooManyDeaths(const __m256i deaths, const __m256i population, const double max_share) {
+    const __m256d limit = _mm256_set1_pd(max_share);
+    const __m256d low = _mm256_cmp_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(deaths)),
+                                      _mm256_mul_pd(limit, _mm256_cvtepi32_pd(_mm256_castsi256_si128(population))),
+                                      _CMP_GT_OQ);
+    const __m256d high = _mm256_cmp_pd(
+        _mm256_cvtepi32_pd(_mm256_extracti128_si256(deaths, 1)),
+        _mm256_mul_pd(limit, _mm256_cvtepi32_pd(_mm256_extracti128_si256(population, 1))), _CMP_GT_OQ);
+    return _mm256_set_m128i(Low32x4(_mm256_castpd_si256(high)), Low32x4(_mm256_castpd_si256(low)));
+}
+
+}  // namespace
+
+AVX2_TARGET void CityBatch::GenerateRandomParamsAvx2(const std::size_t first) {
+    const __m256i over = Load8(&game_over_[first]);
+    if (AllSet(over)) {
+        return;
+    }
+    const Ruleset& rules = rules_ != nullptr ? *rules_ : kDefaultRuleset;
+    // Both halves of the block are drawn in one straight line so that their latency chains overlap.
+    const __m256i year = Load8(&year_[first]);
+    RandomX4 low(_mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&mixed_seed_[first])),
+                                  _mm256_cvtepi32_epi64(_mm256_castsi256_si128(year))));
+    RandomX4 high(_mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&mixed_seed_[first + 4])),
+                                   _mm256_cvtepi32_epi64(_mm256_extracti128_si256(year, 1))));
+    __m256i redo_low = _mm256_setzero_si256();
+    __m256i redo_high = _mm256_setzero_si256();
+
+    const __m256i plague_range = _mm256_set1_epi64x(static_cast<std::uint32_t>(rules.plague_roll_max) + 1);
+    const __m256i plague_roll = _mm256_set_m128i(high.NextInRange(0, plague_range, redo_high),
+                                                 low.NextInRange(0, plague_range, redo_low));
+    const __m256i wheat_per_acre_range = _mm256_set1_epi64x(
+        static_cast<std::uint32_t>(rules.max_wheat_per_acre - rules.min_wheat_per_acre) + 1);
+    const __m256i wheat_per_acre = _mm256_set_m128i(
+        high.NextInRange(rules.min_wheat_per_acre, wheat_per_acre_range, redo_high),
+        low.NextInRange(rules.min_wheat_per_acre, wheat_per_acre_range, redo_low));
+    const __m256d fraction = _mm256_set1_pd(rules.rats_wheat_consumption_fraction);
+    const __m256i wheat = Load8(&wheat_[first]);
+    const __m256i rats_range = _mm256_add_epi32(_mm256_max_epi32(_mm256_set_m128i(
+        _mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(wheat, 1)), fraction)),
+        _mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(wheat)), fraction))),
+        _mm256_setzero_si256()), _mm256_set1_epi32(1));
+    const __m256i rats_ate = _mm256_set_m128i(
+        high.NextInRange(0, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(rats_range, 1)), redo_high),
+        low.NextInRange(0, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(rats_range)), redo_low));
+    const __m256i land_price_range = _mm256_set1_epi64x(
+        static_cast<std::uint32_t>(rules.max_land_price - rules.min_land_price) + 1);
+    const __m256i land_price = _mm256_set_m128i(high.NextInRange(rules.min_land_price, land_price_range, redo_high),
+                                                low.NextInRange(rules.min_land_price, land_price_range, redo_low));
+
+    StoreUnless(&plague_[first],
+                _mm256_and_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(rules.plague_chance), plague_roll),
+                                 _mm256_set1_epi32(1)), over);
+    StoreUnless(&wheat_per_acre_[first], wheat_per_acre, over);
+    StoreUnless(&rats_ate_[first], rats_ate, over);
+    StoreUnless(&land_price_[first], land_price, over);
+
+    const int redo_lanes = (_mm256_movemask_pd(_mm256_castsi256_pd(redo_low)) |
+                            _mm256_movemask_pd(_mm256_castsi256_pd(redo_high)) << 4) &
+                           ~_mm256_movemask_ps(_mm256_castsi256_ps(over));
+    if (redo_lanes != 0) {
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            if (redo_lanes & 1 << lane) {
+                GenerateRandomParams(first + lane);
+            }
+        }
+    }
+}
+
+AVX2_TARGET void CityBatch::ClampDecisionsAvx2(const std::size_t first, const UserInputData& policy) {
+    const __m256i over = Load8(&game_over_[first]);
+    if (AllSet(over)) {
+        return;
+    }
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i wheat = Load8(&wheat_[first]);
+    // Finished cities may have no land price; their decisions are never used.
+    const __m256i price = _mm256_blendv_epi8(Load8(&land_price_[first]), _mm256_set1_epi32(1), over);
+    const __m256i acres_to_buy = _mm256_min_epi32(_mm256_max_epi32(_mm256_set1_epi32(policy.acres_to_buy), zero),
+                                                  _mm256_max_epi32(zero, Divide(wheat, price)));
+    const __m256i acres_to_sell = _mm256_min_epi32(_mm256_max_epi32(_mm256_set1_epi32(policy.acres_to_sell), zero),
+                                                   Load8(&acres_[first]));
+    const __m256i wheat_to_plant = _mm256_min_epi32(
+        _mm256_max_epi32(_mm256_set1_epi32(policy.wheat_to_plant), zero), _mm256_max_epi32(zero, wheat));
+    const __m256i wheat_remaining = _mm256_sub_epi32(
+        _mm256_add_epi32(_mm256_sub_epi32(wheat, _mm256_mullo_epi32(acres_to_buy, price)),
+                         _mm256_mullo_epi32(acres_to_sell, price)),
+        wheat_to_plant);
+    Store8(&acres_to_buy_[first], acres_to_buy);
+    Store8(&acres_to_sell_[first], acres_to_sell);
+    Store8(&wheat_to_plant_[first], wheat_to_plant);
+    Store8(&wheat_to_eat_[first], _mm256_min_epi32(_mm256_max_epi32(_mm256_set1_epi32(policy.wheat_to_eat), zero),
+                                                   _mm256_max_epi32(zero, wheat_remaining)));
+}
+
+AVX2_TARGET void CityBatch::UpdateCityStateAvx2(const std::size_t first) {
+    const __m256i over = Load8(&game_over_[first]);
+    if (AllSet(over)) {
+        return;
+    }
+    const int wheat_per_person = rules_ != nullptr ? rules_->wheat_per_person : kDefaultRuleset.wheat_per_person;
+    const __m256i acres_to_sell = Load8(&acres_to_sell_[first]);
+    const __m256i wheat_to_eat = Load8(&wheat_to_eat_[first]);
+    const __m256i acres = _mm256_add_epi32(Load8(&acres_[first]),
+                                           _mm256_sub_epi32(Load8(&acres_to_buy_[first]), acres_to_sell));
+    const __m256i wheat = _mm256_add_epi32(
+        _mm256_sub_epi32(Load8(&wheat_[first]), _mm256_add_epi32(wheat_to_eat, Load8(&wheat_to_plant_[first]))),
+        _mm256_mullo_epi32(acres_to_sell, Load8(&wheat_per_acre_[first])));
+    const __m256i starvation_deaths = _mm256_max_epi32(
+        _mm256_setzero_si256(),
+        _mm256_sub_epi32(Load8(&population_[first]), Divide(wheat_to_eat, _mm256_set1_epi32(wheat_per_person))));
+    StoreUnless(&acres_[first], acres, over);
+    StoreUnless(&wheat_[first], wheat, over);
+    StoreUnless(&starvation_deaths_[first], starvation_deaths, over);
+}
+
+AVX2_TARGET void CityBatch::ResolveYearAvx2(const std::size_t first) {
+    const __m256i over = Load8(&game_over_[first]);
+    if (AllSet(over)) {
+        return;
+    }
+    const Ruleset& rules = rules_ != nullptr ? *rules_ : kDefaultRuleset;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i year = _mm256_add_epi32(Load8(&year_[first]), one);
+    const __m256i wheat_per_acre = Load8(&wheat_per_acre_[first]);
+    const __m256i total_wheat = _mm256_sub_epi32(_mm256_mullo_epi32(Load8(&acres_[first]), wheat_per_acre),
+                                                 Load8(&rats_ate_[first]));
+    const __m256i wheat = _mm256_add_epi32(Load8(&wheat_[first]), total_wheat);
+
+    const __m256i plague = _mm256_sub_epi32(zero, Load8(&plague_[first]));
+    __m256i population = Load8(&population_[first]);
+    population = _mm256_blendv_epi8(population, Halve(population), plague);
+    const __m256i starvation_deaths = Load8(&starvation_deaths_[first]);
+    population = _mm256_sub_epi32(population, starvation_deaths);
+    const __m256i total_starvation_deaths = _mm256_add_epi32(Load8(&total_starvation_deaths_[first]),
+                                                             starvation_deaths);
+    const __m256i growth = Divide(_mm256_mullo_epi32(_mm256_sub_epi32(_mm256_set1_epi32(5), wheat_per_acre),
+                                                     total_wheat),
+                                  _mm256_set1_epi32(600));
+    const __m256i new_citizens = _mm256_max_epi32(zero, _mm256_min_epi32(
+        _mm256_set1_epi32(50), _mm256_add_epi32(_mm256_add_epi32(Halve(starvation_deaths), growth), one)));
+    population = _mm256_add_epi32(population, new_citizens);
+
+    const __m256i game_over = _mm256_or_si256(
+        TooManyDeaths(starvation_deaths, population, rules.max_starvation_deaths),
+        _mm256_or_si256(_mm256_cmpeq_epi32(population, zero),
+                        _mm256_cmpgt_epi32(year, _mm256_set1_epi32(rules.max_years - 1))));
+
+    StoreUnless(&year_[first], year, over);
+    StoreUnless(&wheat_[first], wheat, over);
+    StoreUnless(&population_[first], population, over);
+    StoreUnless(&total_starvation_deaths_[first], total_starvation_deaths, over);
+    StoreUnless(&new_citizens_[first], new_citizens, over);
+    Store8(&game_over_[first], _mm256_or_si256(over, game_over));
+}
+
+#endif  // HAMMURABI_AVX2
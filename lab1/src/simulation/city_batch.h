@@ -0,0 +1,101 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../game/game_engine.h"
+
+// Many independent reigns stored column by column: one contiguous array per field instead of
+// one GameEngine per city, so a year of every city is resolved in a single pass over the arrays
+// (eight cities at a time with AVX2, one at a time otherwise). A city follows exactly the same
+// rules and random draws as a GameEngine started from the same GameState.
+class CityBatch {
+ public:
+    CityBatch();
+    // `count` cities; city i starts from GameState(seed ^ SplitMix64(first_game + i), rules),
+    // the same seeding EvaluatePolicy uses for game first_game + i. Null `rules` are the stock rules;
+    // otherwise they must outlive the batch.
+    CityBatch(std::uint64_t seed, std::uint64_t first_game, std::size_t count, const Ruleset* rules = nullptr);
+
+    // Starts new reigns, reusing the columns' memory.
+    void Reset(std::uint64_t seed, std::uint64_t first_game, std::size_t count, const Ruleset* rules = nullptr);
+
+    // True when the AVX2 kernels are compiled in and the CPU supports them.
+    [[nodiscard]] static bool IsVectorizationSupported();
+    // Switches between the AVX2 and the scalar kernels; ignored if AVX2 is not supported.
+    void SetVectorized(bool vectorized);
+    [[nodiscard]] bool vectorized() const { return vectorized_; }
+
+    // The batch counterparts of the GameEngine methods. Cities whose game is over are left as they are.
+    void GenerateRandomParams();
+    // Sets every city's decision to `policy` limited by GameEngine::ClampDecision.
+    void ClampDecisions(const UserInputData& policy);
+    void SetDecision(std::size_t city, const UserInputData& decision);
+    // Applies the decisions set by ClampDecisions/SetDecision.
+    void UpdateCityState();
+    void NextYear();
+    // ClampDecisions, UpdateCityState and NextYear fused into one pass over the columns.
+    void PlayYear(const UserInputData& policy);
+    // Plays every reign to the end with the same clamped policy every year.
+    void PlayReign(const UserInputData& policy);
+
+    [[nodiscard]] std::size_t size() const { return size_; }
+    [[nodiscard]] std::size_t cities_playing() const { return playing_; }
+    [[nodiscard]] bool IsGameOver(const std::size_t city) const { return game_over_[city] != 0; }
+    [[nodiscard]] GameState game_state(std::size_t city) const;
+    [[nodiscard]] YearState year_state(std::size_t city) const;
+    [[nodiscard]] GameEngine City(const std::size_t city) const {
+        return GameEngine(game_state(city), year_state(city), rules_);
+    }
+    [[nodiscard]] GameResult CalculateResults(const std::size_t city) const { return City(city).CalculateResults(); }
+
+ private:
+    std::size_t size_;
+    std::size_t playing_;
+    bool vectorized_;
+    const Ruleset* rules_;
+
+    // GameState columns.
+    std::vector<std::int32_t> year_;
+    std::vector<std::int32_t> population_;
+    std::vector<std::int32_t> acres_;
+    std::vector<std::int32_t> wheat_;
+    std::vector<std::uint64_t> seed_;
+    // SplitMix64(seed_), the part of the per-year random stream seed that does not change.
+    std::vector<std::uint64_t> mixed_seed_;
+
+    // YearState columns; plague_ is 0 or 1.
+    std::vector<std::int32_t> starvation_deaths_;
+    std::vector<std::int32_t> new_citizens_;
+    std::vector<std::int32_t> plague_;
+    std::vector<std::int32_t> wheat_per_acre_;
+    std::vector<std::int32_t> rats_ate_;
+    std::vector<std::int32_t> land_price_;
+    std::vector<std::int32_t> total_starvation_deaths_;
+    // 0 while the city is playing, -1 (all bits set) once its game is over.
+    std::vector<std::int32_t> game_over_;
+
+    // Decision columns.
+    std::vector<std::int32_t> acres_to_buy_;
+    std::vector<std::int32_t> acres_to_sell_;
+    std::vector<std::int32_t> wheat_to_plant_;
+    std::vector<std::int32_t> wheat_to_eat_;
+
+    // Scalar kernels for one city.
+    void GenerateRandomParams(std::size_t city);
+    void ClampDecision(std::size_t city, const UserInputData& policy);
+    void UpdateCityState(std::size_t city);
+    void ResolveYear(std::size_t city);
+
+    // AVX2 kernels for the block of eight cities starting at `first`, skipping finished games;
+    // defined only where the compiler can target AVX2.
+    void GenerateRandomParamsAvx2(std::size_t first);
+    void ClampDecisionsAvx2(std::size_t first, const UserInputData& policy);
+    void UpdateCityStateAvx2(std::size_t first);
+    void ResolveYearAvx2(std::size_t first);
+
+    void CountPlaying();
+};
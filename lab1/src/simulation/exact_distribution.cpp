@@ -0,0 +1,303 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include "exact_distribution.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "work_stealing_pool.h"
+#include "../utils/random.h"
+
+constexpr int kShardBits = 6;
+constexpr std::uint32_t kShards = 1u << kShardBits;
+constexpr std::size_t kCitiesPerTask = 16;
+constexpr std::size_t kMinTableSlots = 1024;
+
+namespace {
+
+// A city at the start of a year and its probability. Population and acres share one word, wheat
+// and starvation deaths the other; no city has every bit of the second word set.
+struct City {
+    std::uint64_t population_acres;
+    std::uint64_t wheat_deaths;
+    double probability;
+};
+
+constexpr std::uint64_t kEmpty = ~std::uint64_t{0};
+
+std::uint64_t PackPair(const int high, const int low) {
+    return static_cast<std::uint64_t>(static_cast<std::uint32_t>(high)) << 32 | static_cast<std::uint32_t>(low);
+}
+
+int High(const std::uint64_t pair) { return static_cast<std::int32_t>(pair >> 32); }
+int Low(const std::uint64_t pair) { return static_cast<std::int32_t>(pair & 0xFFFFFFFFu); }
+
+std::uint64_t Hash(const City& city) {
+    return SplitMix64(city.population_acres ^ SplitMix64(city.wheat_deaths));
+}
+
+std::uint32_t ShardOf(const std::uint64_t hash) {
+    return static_cast<std::uint32_t>(hash >> (64 - kShardBits));
+}
+
+// Open addressing with linear probing over a power-of-two number of slots, kept at most half full.
+class CityTable {
+ public:
+    [[nodiscard]] std::size_t size() const { return size_; }
+
+    void Add(const City& city, const std::uint64_t hash) {
+        if ((size_ + 1) * 2 > slots_.size()) {
+            Grow();
+        }
+        const std::size_t mask = slots_.size() - 1;
+        for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+            City& slot = slots_[i];
+            if (slot.wheat_deaths == kEmpty) {
+                slot = city;
+                ++size_;
+                return;
+            }
+            if (slot.population_acres == city.population_acres && slot.wheat_deaths == city.wheat_deaths) {
+                slot.probability += city.probability;
+                return;
+            }
+        }
+    }
+
+    // Adds every city of `other` and empties it, keeping its slots for reuse.
+    void Absorb(CityTable& other) {
+        if (other.size_ == 0) {
+            return;
+        }
+        for (City& slot : other.slots_) {
+            if (slot.wheat_deaths != kEmpty) {
+                Add(slot, Hash(slot));
+                slot.wheat_deaths = kEmpty;
+            }
+        }
+        other.size_ = 0;
+    }
+
+    void AppendTo(std::vector<City>& cities) const {
+        for (const City& slot : slots_) {
+            if (slot.wheat_deaths != kEmpty) {
+                cities.push_back(slot);
+            }
+        }
+    }
+
+ private:
+    void Grow() {
+        std::vector<City> old(std::max(kMinTableSlots, slots_.size() * 2), City{0, kEmpty, 0});
+        old.swap(slots_);
+        size_ = 0;
+        for (const City& slot : old) {
+            if (slot.wheat_deaths != kEmpty) {
+                Add(slot, Hash(slot));
+            }
+        }
+    }
+
+    std::vector<City> slots_;
+    std::size_t size_ = 0;
+};
+
+// Per-worker tables of next year's cities and tallies of finished reigns, padded so that workers
+// never share a cache line.
+struct alignas(64) Worker {
+    std::array<CityTable, kShards> next;
+    ExactResult finished;
+    // Distinct clamped decisions of the current city and how many land prices lead to each.
+    std::vector<std::pair<UserInputData, int>> decisions;
+};
+
+void Send(Worker& worker, const City& city) {
+    const std::uint64_t hash = Hash(city);
+    worker.next[ShardOf(hash)].Add(city, hash);
+}
+
+int FloorDiv(const int value, const int divisor) {
+    return value / divisor - (value % divisor < 0 ? 1 : 0);
+}
+
+// Sends `probability` for every amount of grain in [low, high] to the wheat grid. Grain between two
+// grid points is shared between them in proportion to how close it is to each; on a grid of 1 every
+// amount is a grid point of its own.
+void SendRange(Worker& worker, const std::uint64_t population_acres, const int deaths, const int low,
+               const int high, const double probability, const int wheat_step) {
+    // Probability already bound for `point` from the grid cell below it.
+    double carried = 0;
+    int point = FloorDiv(low, wheat_step) * wheat_step;
+    for (; point <= high; point += wheat_step) {
+        const int first = std::max(low, point);
+        const int last = std::min(high, point + wheat_step - 1);
+        const int count = last - first + 1;
+        const double offsets = (static_cast<double>(first - point) + (last - point)) * count / 2;
+        const double upper = probability * offsets / wheat_step;
+        Send(worker, {population_acres, PackPair(point, deaths), carried + probability * count - upper});
+        carried = upper;
+    }
+    if (carried > 0) {
+        Send(worker, {population_acres, PackPair(point, deaths), carried});
+    }
+}
+
+GameEngine Resolve(const GameEngine& updated, YearState drawn, const int rats, const Ruleset* rules) {
+    drawn.rats_ate = rats;
+    GameEngine resolved(updated.game_state(), drawn, rules);
+    resolved.ResolveYear();
+    return resolved;
+}
+
+bool SameDecision(const UserInputData& a, const UserInputData& b) {
+    return a.acres_to_buy == b.acres_to_buy && a.acres_to_sell == b.acres_to_sell &&
+           a.wheat_to_plant == b.wheat_to_plant && a.wheat_to_eat == b.wheat_to_eat;
+}
+
+void Finish(const GameEngine& engine, const double probability, ExactResult& finished) {
+    const GameState& state = engine.game_state();
+    finished.results[static_cast<int>(engine.CalculateResults())] += probability;
+    finished.population[std::clamp(state.population_ / 10, 0, 63)] += probability;
+    finished.acres_per_person[std::clamp(state.population_ > 0 ? state.acres_ / state.population_ : 0, 0, 31)] +=
+        probability;
+}
+
+// Plays one year of `city` through every combination of draws GenerateRandomParams can make.
+void PlayYear(const City& city, const int year, const UserInputData& policy, const Ruleset* rules,
+              const int max_deaths, const int wheat_step, Worker& worker) {
+    const Ruleset& stock = rules != nullptr ? *rules : kDefaultRuleset;
+    GameState state(0);
+    state.year_ = year;
+    state.population_ = High(city.population_acres);
+    state.acres_ = Low(city.population_acres);
+    state.wheat_ = High(city.wheat_deaths);
+    const int deaths = Low(city.wheat_deaths);
+
+    const int rats_max = std::max(0, static_cast<int>(state.wheat_ * stock.rats_wheat_consumption_fraction));
+    const int plague_rolls = stock.plague_roll_max + 1;
+    const double plague_probability =
+        static_cast<double>(std::clamp(stock.plague_chance, 0, plague_rolls)) / plague_rolls;
+    const int prices = stock.max_land_price - stock.min_land_price + 1;
+    const int yields = stock.max_wheat_per_acre - stock.min_wheat_per_acre + 1;
+
+    // The land price only matters through the decision it allows, so prices that clamp the policy
+    // to the same decision are played once.
+    worker.decisions.clear();
+    for (int price = stock.min_land_price; price <= stock.max_land_price; ++price) {
+        const GameEngine engine(state, YearState{0, 0, false, 0, 0, price, deaths}, rules);
+        const UserInputData decision = engine.ClampDecision(policy);
+        const auto same = std::find_if(worker.decisions.begin(), worker.decisions.end(),
+                                       [&](const auto& seen) { return SameDecision(seen.first, decision); });
+        if (same != worker.decisions.end()) {
+            ++same->second;
+        } else {
+            worker.decisions.emplace_back(decision, 1);
+        }
+    }
+
+    for (const auto& [decision, price_count] : worker.decisions) {
+        for (int wheat_per_acre = stock.min_wheat_per_acre; wheat_per_acre <= stock.max_wheat_per_acre;
+             ++wheat_per_acre) {
+            GameEngine engine(state, YearState{0, 0, false, wheat_per_acre, 0, 0, deaths}, rules);
+            engine.UpdateCityState(decision);
+            YearState drawn = engine.year_state();
+            const double probability = city.probability * price_count / prices / yields / (rats_max + 1);
+            for (const bool plague : {false, true}) {
+                const double branch = probability * (plague ? plague_probability : 1 - plague_probability);
+                if (branch == 0) {
+                    continue;
+                }
+                drawn.plague = plague;
+                // The rats only change the city through its grain, one for one, and through the
+                // new citizens, whose number moves monotonically with them. So the rats amounts
+                // that leave the same population form runs, and each run is found by bisection
+                // and sent on as one range of grain.
+                for (int first = 0; first <= rats_max;) {
+                    const GameEngine resolved = Resolve(engine, drawn, first, rules);
+                    const int population = resolved.game_state().population_;
+                    int last = first;
+                    int high = rats_max;
+                    if (Resolve(engine, drawn, high, rules).game_state().population_ == population) {
+                        last = high;
+                    }
+                    for (--high; last < high;) {
+                        const int middle = last + (high - last + 1) / 2;
+                        if (Resolve(engine, drawn, middle, rules).game_state().population_ == population) {
+                            last = middle;
+                        } else {
+                            high = middle - 1;
+                        }
+                    }
+                    const int count = last - first + 1;
+                    worker.finished.transitions += count;
+                    if (resolved.IsGameOver()) {
+                        Finish(resolved, branch * count, worker.finished);
+                    } else {
+                        const GameState& next = resolved.game_state();
+                        SendRange(worker, PackPair(next.population_, next.acres_),
+                                  std::min(resolved.total_starvation_deaths(), max_deaths),
+                                  next.wheat_ - (last - first), next.wheat_, branch, wheat_step);
+                    }
+                    first = last + 1;
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+ExactResult EvaluatePolicyExactly(const UserInputData& policy, const ExactOptions& options, const Ruleset* rules) {
+    const WorkStealingPool pool(options.threads);
+    const int wheat_step = std::max(1, options.wheat_step);
+    const Ruleset& stock = rules != nullptr ? *rules : kDefaultRuleset;
+    // CalculateResults only asks whether the average deaths per year exceed 0.33, 0.1 and 0.03,
+    // so totals past the highest threshold over the whole reign need not be told apart.
+    const int max_deaths = static_cast<int>(0.33 * stock.max_years) + 1;
+    const std::unique_ptr<Worker[]> workers(new Worker[pool.threads()]);
+
+    const GameState start(0, stock);
+    std::vector<City> cities = {{PackPair(start.population_, start.acres_), PackPair(start.wheat_, 0), 1.0}};
+    ExactResult result;
+    for (int year = start.year_; !cities.empty(); ++year) {
+        result.states_per_year.push_back(cities.size());
+        const auto tasks = static_cast<std::uint32_t>((cities.size() + kCitiesPerTask - 1) / kCitiesPerTask);
+        pool.Run(tasks, [&](const unsigned worker, const std::uint32_t task) {
+            const std::size_t end = std::min(cities.size(), (task + 1) * kCitiesPerTask);
+            for (std::size_t i = task * kCitiesPerTask; i < end; ++i) {
+                PlayYear(cities[i], year, policy, rules, max_deaths, wheat_step, workers[worker]);
+            }
+        });
+
+        // Every shard of next year is merged from all workers' tables independently.
+        std::array<std::vector<City>, kShards> shards;
+        pool.Run(kShards, [&](unsigned, const std::uint32_t shard) {
+            CityTable merged;
+            for (unsigned worker = 0; worker < pool.threads(); ++worker) {
+                merged.Absorb(workers[worker].next[shard]);
+            }
+            shards[shard].reserve(merged.size());
+            merged.AppendTo(shards[shard]);
+        });
+        cities.clear();
+        for (const std::vector<City>& shard : shards) {
+            cities.insert(cities.end(), shard.begin(), shard.end());
+        }
+    }
+
+    for (unsigned worker = 0; worker < pool.threads(); ++worker) {
+        const ExactResult& finished = workers[worker].finished;
+        for (int i = 0; i < kGameResultCount; ++i) {
+            result.results[i] += finished.results[i];
+        }
+        for (std::size_t i = 0; i < result.population.size(); ++i) {
+            result.population[i] += finished.population[i];
+        }
+        for (std::size_t i = 0; i < result.acres_per_person.size(); ++i) {
+            result.acres_per_person[i] += finished.acres_per_person[i];
+        }
+        result.transitions += finished.transitions;
+    }
+    return result;
+}
@@ -0,0 +1,47 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "monte_carlo.h"
+#include "../game/game_engine.h"
+
+// Probabilities of the same outcomes MonteCarloResult counts.
+struct ExactResult {
+    std::array<double, kGameResultCount> results{};
+    // Final population, 10 citizens per bin.
+    std::array<double, 64> population{};
+    // Final acres per person, 1 acre per bin.
+    std::array<double, 32> acres_per_person{};
+    // Distinct cities alive at the start of each year, from the first.
+    std::vector<std::size_t> states_per_year;
+    // Every (city, land price, harvest, rats, plague) combination that was played out.
+    std::uint64_t transitions = 0;
+};
+
+struct ExactOptions {
+    unsigned threads = std::thread::hardware_concurrency();
+    // Grain is tracked in multiples of this; 1 is exact. The cities grow several times over every
+    // year, mostly in how much grain they hold, so a full stock reign needs a coarser grid: a
+    // city's grain that falls between two grid points is split between them in proportion, which
+    // keeps the total and the mean of every year's grain but smooths the next year's rats draw.
+    int wheat_step = 1;
+};
+
+// The exact distribution of outcomes of a fixed policy (the same clamped decision every year),
+// found without sampling. Every year's random draws take only a few values each, so the
+// calculator carries the probability of every distinct city (population, acres, wheat and the
+// starvation deaths CalculateResults can tell apart) from year to year, playing each one through
+// GameEngine for every combination of draws and merging the cities that come out the same in an
+// open-addressing table keyed on the packed city.
+//
+// Every year's cities are split across the threads; each worker merges into its own tables, which
+// are then combined shard by shard. Probabilities are summed in doubles, so the last bits may
+// depend on scheduling. Null `rules` are the stock rules.
+ExactResult EvaluatePolicyExactly(const UserInputData& policy, const ExactOptions& options = ExactOptions(),
+                                  const Ruleset* rules = nullptr);
@@ -0,0 +1,81 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include "monte_carlo.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "city_batch.h"
+#include "work_stealing_pool.h"
+
+constexpr std::uint64_t kGamesPerChunk = 4096;
+
+namespace {
+
+// Per-worker tallies and city columns, padded so that workers never share a cache line.
+struct alignas(64) WorkerResult {
+    MonteCarloResult result;
+    CityBatch cities;
+};
+
+template<std::size_t Bins>
+void Merge(std::array<std::atomic<std::uint64_t>, Bins>& total, const Histogram<Bins>& part) {
+    for (std::size_t i = 0; i < Bins; ++i) {
+        if (part.counts[i] != 0) {
+            total[i].fetch_add(part.counts[i], std::memory_order_relaxed);
+        }
+    }
+}
+
+template<std::size_t Bins>
+void Load(Histogram<Bins>& out, const std::array<std::atomic<std::uint64_t>, Bins>& total) {
+    for (std::size_t i = 0; i < Bins; ++i) {
+        out.counts[i] = total[i].load(std::memory_order_relaxed);
+    }
+}
+
+}  // namespace
+
+MonteCarloResult EvaluatePolicy(const UserInputData& policy, const std::uint64_t games, const std::uint64_t seed,
+                                const unsigned threads, const Ruleset* rules) {
+    const WorkStealingPool pool(threads);
+    const auto chunks = static_cast<std::uint32_t>((games + kGamesPerChunk - 1) / kGamesPerChunk);
+    const std::unique_ptr<WorkerResult[]> partial(new WorkerResult[pool.threads()]);
+
+    std::atomic<std::uint64_t> total_games{0};
+    std::array<std::atomic<std::uint64_t>, kGameResultCount> results{};
+    std::array<std::atomic<std::uint64_t>, 64> population{};
+    std::array<std::atomic<std::uint64_t>, 32> acres_per_person{};
+
+    pool.Run(chunks, [&](const unsigned worker, const std::uint32_t chunk) {
+        MonteCarloResult& local = partial[worker].result;
+        CityBatch& cities = partial[worker].cities;
+        const std::uint64_t first = chunk * kGamesPerChunk;
+        cities.Reset(seed, first, std::min(games, first + kGamesPerChunk) - first, rules);
+        cities.PlayReign(policy);
+        for (std::size_t city = 0; city < cities.size(); ++city) {
+            const GameState final_state = cities.game_state(city);
+            local.results.Add(static_cast<int>(cities.CalculateResults(city)));
+            local.population.Add(final_state.population_ / 10);
+            local.acres_per_person.Add(final_state.population_ > 0 ? final_state.acres_ / final_state.population_ : 0);
+            ++local.games;
+        }
+    });
+
+    // Each worker's tallies are folded into the totals with relaxed atomic adds.
+    pool.Run(pool.threads(), [&](unsigned, const std::uint32_t worker) {
+        const MonteCarloResult& local = partial[worker].result;
+        total_games.fetch_add(local.games, std::memory_order_relaxed);
+        Merge(results, local.results);
+        Merge(population, local.population);
+        Merge(acres_per_person, local.acres_per_person);
+    });
+
+    MonteCarloResult merged;
+    merged.games = total_games.load(std::memory_order_relaxed);
+    Load(merged.results, results);
+    Load(merged.population, population);
+    Load(merged.acres_per_person, acres_per_person);
+    return merged;
+}
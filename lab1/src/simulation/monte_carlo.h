@@ -0,0 +1,36 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "../game/game_engine.h"
+
+constexpr int kGameResultCount = static_cast<int>(GameResult::kFantastic) + 1;
+
+template<std::size_t Bins>
+struct Histogram {
+    std::array<std::uint64_t, Bins> counts{};
+
+    // Values beyond the last bin are counted in it.
+    void Add(const int bin) { ++counts[std::clamp<std::size_t>(std::max(bin, 0), 0, Bins - 1)]; }
+};
+
+struct MonteCarloResult {
+    std::uint64_t games = 0;
+    Histogram<kGameResultCount> results;
+    // Final population, 10 citizens per bin.
+    Histogram<64> population;
+    // Final acres per person, 1 acre per bin.
+    Histogram<32> acres_per_person;
+};
+
+// Plays `games` independent reigns of a fixed policy (the same clamped decision
+// every year) on `threads` workers. Game i is seeded from `seed` and i, so the
+// result does not depend on the number of threads or on scheduling. Null `rules`
+// are the stock rules.
+MonteCarloResult EvaluatePolicy(const UserInputData& policy, std::uint64_t games, std::uint64_t seed,
+                                unsigned threads, const Ruleset* rules = nullptr);
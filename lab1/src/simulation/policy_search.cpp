@@ -0,0 +1,190 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include "policy_search.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numeric>
+
+#include "city_batch.h"
+#include "work_stealing_pool.h"
+#include "../utils/random.h"
+
+constexpr std::uint64_t kGamesPerChunk = 4096;
+
+namespace {
+
+// Salts that keep the streams of games, breeding and the first generation apart.
+constexpr std::uint64_t kGameStream = 1;
+constexpr std::uint64_t kBreedStream = 2;
+constexpr std::uint64_t kFirstGenerationStream = 3;
+
+std::uint64_t Mix(const std::uint64_t a, const std::uint64_t b) {
+    return SplitMix64(a ^ SplitMix64(b));
+}
+
+Random StreamFor(const std::uint64_t seed, const std::uint64_t stream, const int generation,
+                 const std::size_t individual) {
+    return Random(Mix(Mix(Mix(seed, stream), static_cast<std::uint64_t>(generation)), individual));
+}
+
+double NextUnit(Random& random) {
+    return static_cast<double>(random.Next() >> 11) * 0x1.0p-53;
+}
+
+// Box-Muller, so that the search gives the same numbers with every standard library.
+double NextNormal(Random& random) {
+    constexpr double kTwoPi = 6.283185307179586;
+    const double radius = std::sqrt(-2.0 * std::log(1.0 - NextUnit(random)));
+    return radius * std::cos(kTwoPi * NextUnit(random));
+}
+
+// Sum of the scores of `count` reigns, city i seeded like game first_game + i of EvaluatePolicy.
+double PlayGames(CityBatch& cities, const Strategy& strategy, const std::uint64_t seed, const std::uint64_t first_game,
+                 const std::size_t count, const Ruleset* rules,
+                 const std::array<double, kGameResultCount>& result_scores) {
+    cities.Reset(seed, first_game, count, rules);
+    cities.GenerateRandomParams();
+    while (cities.cities_playing() > 0) {
+        for (std::size_t city = 0; city < cities.size(); ++city) {
+            if (!cities.IsGameOver(city)) {
+                cities.SetDecision(city, strategy.Decide(cities.City(city)));
+            }
+        }
+        cities.UpdateCityState();
+        cities.NextYear();
+    }
+    double total = 0;
+    for (std::size_t city = 0; city < cities.size(); ++city) {
+        total += result_scores[static_cast<int>(cities.CalculateResults(city))];
+    }
+    return total;
+}
+
+}  // namespace
+
+UserInputData Strategy::Decide(const GameEngine& engine) const {
+    const GameState& state = engine.game_state();
+    const int price = engine.land_price();
+    const int wheat = std::max(0, state.wheat_);
+    const int need = std::max(0, state.population_) * engine.rules().wheat_per_person;
+    const int eat = std::min(wheat, static_cast<int>(feed * need));
+    const int plant_budget = wheat - eat;
+    const int to_plant = static_cast<int>(plant * plant_budget);
+    const int buy = price <= buy_price ? static_cast<int>(buy_share * (plant_budget - to_plant) / price) : 0;
+    const int sell = price >= sell_price ? static_cast<int>(sell_share * state.acres_) : 0;
+    return engine.ClampDecision({buy, sell, to_plant, eat});
+}
+
+PolicySearch::PolicySearch(const SearchOptions& options, const Ruleset* rules)
+    : options_(options), rules_(rules), generation_(0), best_score_(0), mean_score_(0) {
+    const Ruleset& stock = rules != nullptr ? *rules : kDefaultRuleset;
+    // Price thresholds reach one past either end of the price range, so that "never" and "always"
+    // are both within reach.
+    const double min_price = stock.min_land_price - 1;
+    const double max_price = stock.max_land_price + 1;
+    genes_ = {{
+        {&Strategy::feed, 0.0, 1.5},
+        {&Strategy::plant, 0.0, 1.0},
+        {&Strategy::buy_price, min_price, max_price},
+        {&Strategy::buy_share, 0.0, 1.0},
+        {&Strategy::sell_price, min_price, max_price},
+        {&Strategy::sell_share, 0.0, 1.0},
+    }};
+    options_.population = std::max<std::size_t>(1, options_.population);
+    options_.elite = std::min(options_.elite, options_.population);
+    options_.tournament = std::max(1, options_.tournament);
+
+    population_.resize(options_.population);
+    for (std::size_t i = 0; i < population_.size(); ++i) {
+        Random random = StreamFor(options_.seed, kFirstGenerationStream, 0, i);
+        for (const Gene& gene : genes_) {
+            population_[i].*gene.field = gene.min + (gene.max - gene.min) * NextUnit(random);
+        }
+    }
+}
+
+void PolicySearch::RunGeneration() {
+    ScoreGeneration();
+    Breed();
+    ++generation_;
+}
+
+void PolicySearch::ScoreGeneration() {
+    const WorkStealingPool pool(options_.threads);
+    const std::unique_ptr<CityBatch[]> cities(new CityBatch[pool.threads()]);
+    const std::uint64_t seed = Mix(Mix(options_.seed, kGameStream), static_cast<std::uint64_t>(generation_));
+    scores_.assign(population_.size(), 0);
+    pool.Run(static_cast<std::uint32_t>(population_.size()), [&](const unsigned worker, const std::uint32_t i) {
+        const std::uint64_t first_game = options_.common_games ? 0 : i * options_.games;
+        double total = 0;
+        for (std::uint64_t game = 0; game < options_.games; game += kGamesPerChunk) {
+            const auto count = static_cast<std::size_t>(std::min(kGamesPerChunk, options_.games - game));
+            total += PlayGames(cities[worker], population_[i], seed, first_game + game, count, rules_,
+                               options_.result_scores);
+        }
+        scores_[i] = options_.games > 0 ? total / static_cast<double>(options_.games) : 0;
+    });
+
+    const auto best = std::max_element(scores_.begin(), scores_.end());
+    best_ = population_[best - scores_.begin()];
+    best_score_ = *best;
+    mean_score_ = std::accumulate(scores_.begin(), scores_.end(), 0.0) / static_cast<double>(scores_.size());
+}
+
+void PolicySearch::Breed() {
+    // Ties go to the earlier individual, which keeps the order independent of the sort.
+    std::vector<std::uint32_t> ranking(population_.size());
+    std::iota(ranking.begin(), ranking.end(), 0);
+    std::stable_sort(ranking.begin(), ranking.end(),
+                     [this](const std::uint32_t a, const std::uint32_t b) { return scores_[a] > scores_[b]; });
+
+    std::vector<Strategy> next(population_.size());
+    for (std::size_t i = 0; i < options_.elite; ++i) {
+        next[i] = population_[ranking[i]];
+    }
+    const auto pick = [this](Random& random) {
+        auto winner = static_cast<std::size_t>(random.NextInRange(0, static_cast<int>(population_.size()) - 1));
+        for (int round = 1; round < options_.tournament; ++round) {
+            const auto rival = static_cast<std::size_t>(random.NextInRange(0, static_cast<int>(population_.size()) - 1));
+            if (scores_[rival] > scores_[winner] || (scores_[rival] == scores_[winner] && rival < winner)) {
+                winner = rival;
+            }
+        }
+        return winner;
+    };
+
+    const WorkStealingPool pool(options_.threads);
+    const std::uint32_t children = static_cast<std::uint32_t>(population_.size() - options_.elite);
+    pool.Run(children, [&](unsigned, const std::uint32_t child) {
+        Random random = StreamFor(options_.seed, kBreedStream, generation_, child);
+        const Strategy& mother = population_[pick(random)];
+        const Strategy& father = population_[pick(random)];
+        Strategy& offspring = next[options_.elite + child];
+        for (const Gene& gene : genes_) {
+            // Blend crossover: anywhere between the parents and a little beyond either of them.
+            const double low = std::min(mother.*gene.field, father.*gene.field);
+            const double high = std::max(mother.*gene.field, father.*gene.field);
+            const double spread = 0.25 * (high - low);
+            double value = low - spread + (high - low + 2 * spread) * NextUnit(random);
+            value += options_.mutation * (gene.max - gene.min) * NextNormal(random);
+            offspring.*gene.field = std::clamp(value, gene.min, gene.max);
+        }
+    });
+    population_.swap(next);
+}
+
+double PolicySearch::Evaluate(const Strategy& strategy, const std::uint64_t games, const std::uint64_t seed) const {
+    const WorkStealingPool pool(options_.threads);
+    const std::unique_ptr<CityBatch[]> cities(new CityBatch[pool.threads()]);
+    const auto chunks = static_cast<std::uint32_t>((games + kGamesPerChunk - 1) / kGamesPerChunk);
+    std::vector<double> totals(chunks, 0);
+    pool.Run(chunks, [&](const unsigned worker, const std::uint32_t chunk) {
+        const std::uint64_t first = chunk * kGamesPerChunk;
+        totals[chunk] = PlayGames(cities[worker], strategy, seed, first,
+                                  static_cast<std::size_t>(std::min(games, first + kGamesPerChunk) - first), rules_,
+                                  options_.result_scores);
+    });
+    return games > 0 ? std::accumulate(totals.begin(), totals.end(), 0.0) / static_cast<double>(games) : 0;
+}
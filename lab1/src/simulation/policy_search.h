@@ -0,0 +1,93 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "monte_carlo.h"
+#include "../game/game_engine.h"
+
+// A policy that reacts to the city and the land price, described by a few numbers.
+struct Strategy {
+    // Grain eaten, as a multiple of what feeds every citizen.
+    double feed = 1.0;
+    // Share of the grain left after eating that is planted.
+    double plant = 0.0;
+    // Land is bought when it costs at most buy_price, with this share of the grain still left.
+    double buy_price = 0.0;
+    double buy_share = 0.0;
+    // This share of the land is sold when it costs at least sell_price.
+    double sell_price = 100.0;
+    double sell_share = 0.0;
+
+    // The year's decision, limited by GameEngine::ClampDecision; usable as a PlayReign policy.
+    [[nodiscard]] UserInputData Decide(const GameEngine& engine) const;
+    [[nodiscard]] UserInputData operator()(const GameEngine& engine) const { return Decide(engine); }
+};
+
+struct SearchOptions {
+    unsigned threads = std::thread::hardware_concurrency();
+    std::size_t population = 1000;
+    // Games every individual plays per generation.
+    std::uint64_t games = 1000;
+    std::uint64_t seed = 0;
+    // When set, every individual of a generation plays the same games, so that strategies are
+    // ranked on equal luck; otherwise each plays games of its own.
+    bool common_games = true;
+    // Best individuals carried over unchanged into the next generation.
+    std::size_t elite = 10;
+    // Individuals drawn for every tournament that picks a parent.
+    int tournament = 3;
+    // Standard deviation of a mutation, as a share of the gene's range.
+    double mutation = 0.05;
+    // Score of every verdict tier; a strategy's fitness is the mean over its games.
+    std::array<double, kGameResultCount> result_scores = {0, 1, 2, 3, 4, 5};
+};
+
+// Evolves Strategy parameters with a genetic algorithm: tournament selection, blend crossover,
+// Gaussian mutation and elitism. Every individual is scored by playing SearchOptions::games
+// reigns in a CityBatch, individuals are spread over the threads, and every random choice comes
+// from a stream derived from the seed, the generation and the individual, so a search does not
+// depend on the number of threads. Null `rules` are the stock rules; otherwise they must outlive
+// the search.
+class PolicySearch {
+ public:
+    explicit PolicySearch(const SearchOptions& options = SearchOptions(), const Ruleset* rules = nullptr);
+
+    // Scores the current generation and breeds the next one from it.
+    void RunGeneration();
+
+    [[nodiscard]] int generation() const { return generation_; }
+    [[nodiscard]] const std::vector<Strategy>& population() const { return population_; }
+    // Best individual and fitnesses of the generation scored last.
+    [[nodiscard]] const Strategy& best() const { return best_; }
+    [[nodiscard]] double best_score() const { return best_score_; }
+    [[nodiscard]] double mean_score() const { return mean_score_; }
+
+    // Mean score of `strategy` over `games` reigns, seeded as EvaluatePolicy seeds them.
+    [[nodiscard]] double Evaluate(const Strategy& strategy, std::uint64_t games, std::uint64_t seed) const;
+
+ private:
+    struct Gene {
+        double Strategy::* field;
+        double min;
+        double max;
+    };
+
+    void ScoreGeneration();
+    void Breed();
+
+    SearchOptions options_;
+    const Ruleset* rules_;
+    std::array<Gene, 6> genes_;
+    int generation_;
+    std::vector<Strategy> population_;
+    std::vector<double> scores_;
+    Strategy best_;
+    double best_score_;
+    double mean_score_;
+};
@@ -0,0 +1,382 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include "policy_solver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+#include "work_stealing_pool.h"
+
+constexpr int kPopulationStep = 20;
+constexpr int kPopulationLevels = 32;
+constexpr int kAmountLevels = 48;
+constexpr int kDeathLevels = 5;
+constexpr std::uint32_t kCells = kPopulationLevels * kAmountLevels * kAmountLevels * kDeathLevels;
+constexpr std::uint32_t kCellsPerTask = 64;
+
+constexpr double kEatFractions[] = {1.0, 0.8, 0.6};
+constexpr double kBuyFractions[] = {0.0, 0.5, 1.0};
+constexpr double kSellFractions[] = {0.0, 0.5};
+constexpr int kDecisions = std::size(kEatFractions) * std::size(kBuyFractions) * std::size(kSellFractions);
+
+// The grid, price bands and outcome table below are tuned for the stock rules.
+constexpr const Ruleset& kRules = kDefaultRuleset;
+
+namespace {
+
+struct PriceBand {
+    int max_price;
+    int price;
+    double probability;
+};
+
+constexpr int kLandPrices = kRules.max_land_price - kRules.min_land_price + 1;
+constexpr PriceBand kPriceBands[] = {
+    {19, 18, 3.0 / kLandPrices},
+    {23, 21, 4.0 / kLandPrices},
+    {kRules.max_land_price, 25, 3.0 / kLandPrices},
+};
+constexpr int kPriceBandCount = std::size(kPriceBands);
+
+int PriceBandOf(const int price) {
+    int band = 0;
+    while (band + 1 < kPriceBandCount && price > kPriceBands[band].max_price) {
+        ++band;
+    }
+    return band;
+}
+
+// Hidden draws of GenerateRandomParams; rats always eat the median of their draw.
+struct Outcome {
+    bool plague;
+    int wheat_per_acre;
+    double rats_fraction;
+    double probability;
+};
+
+constexpr double kRatsQuartiles[] = {0.5};
+constexpr int kWheatPerAcreCount = kRules.max_wheat_per_acre - kRules.min_wheat_per_acre + 1;
+constexpr int kOutcomeCount = 2 * kWheatPerAcreCount * std::size(kRatsQuartiles);
+
+constexpr std::array<Outcome, kOutcomeCount> MakeOutcomes() {
+    constexpr double plague_probability = static_cast<double>(kRules.plague_chance) /
+                                          (kRules.plague_roll_max + 1);
+    std::array<Outcome, kOutcomeCount> outcomes{};
+    int i = 0;
+    for (const bool plague : {false, true}) {
+        for (int wheat_per_acre = kRules.min_wheat_per_acre; wheat_per_acre <= kRules.max_wheat_per_acre;
+             ++wheat_per_acre) {
+            for (const double rats : kRatsQuartiles) {
+                outcomes[i++] = {plague, wheat_per_acre, rats,
+                                 (plague ? plague_probability : 1 - plague_probability) / kWheatPerAcreCount /
+                                 std::size(kRatsQuartiles)};
+            }
+        }
+    }
+    return outcomes;
+}
+
+constexpr std::array<Outcome, kOutcomeCount> kOutcomes = MakeOutcomes();
+
+// Half-octave level: 0 for nothing, then two levels per power of two.
+int AmountLevel(const int amount) {
+    if (amount <= 0) {
+        return 0;
+    }
+    const int width = std::bit_width(static_cast<unsigned>(amount));
+    const int upper_half = width >= 2 ? (amount >> (width - 2)) & 1 : 0;
+    return std::min(kAmountLevels - 1, 2 * width - 1 + upper_half);
+}
+
+int AmountOf(const int level) {
+    if (level == 0) {
+        return 0;
+    }
+    const int base = 1 << ((level + 1) / 2 - 1);
+    return level % 2 == 1 ? base + base / 4 : base + base * 3 / 4;
+}
+
+std::uint32_t CellOf(const GameState& state, const int deaths) {
+    const int population = std::clamp(state.population_ / kPopulationStep, 0, kPopulationLevels - 1);
+    return ((static_cast<std::uint32_t>(population) * kAmountLevels + AmountLevel(state.acres_)) * kAmountLevels +
+            AmountLevel(state.wheat_)) * kDeathLevels + std::min(deaths, kDeathLevels - 1);
+}
+
+GameState StateOf(std::uint32_t cell, const int year, int& deaths) {
+    deaths = static_cast<int>(cell % kDeathLevels);
+    cell /= kDeathLevels;
+    GameState state(0);
+    state.year_ = year;
+    state.wheat_ = AmountOf(static_cast<int>(cell % kAmountLevels));
+    cell /= kAmountLevels;
+    state.acres_ = AmountOf(static_cast<int>(cell % kAmountLevels));
+    state.population_ = static_cast<int>(cell / kAmountLevels) * kPopulationStep + kPopulationStep / 2;
+    return state;
+}
+
+// Transitions do not depend on the land price unless the decision buys land.
+bool DependsOnPrice(const int index) {
+    return kBuyFractions[index / std::size(kSellFractions) % std::size(kBuyFractions)] != 0.0;
+}
+
+UserInputData MakeDecision(const GameState& state, const int price, const int index) {
+    const double eat_fraction = kEatFractions[index / (std::size(kBuyFractions) * std::size(kSellFractions))];
+    const double buy_fraction = kBuyFractions[index / std::size(kSellFractions) % std::size(kBuyFractions)];
+    const double sell_fraction = kSellFractions[index % std::size(kSellFractions)];
+
+    const int wheat = std::max(0, state.wheat_);
+    const int need = std::max(0, state.population_) * kRules.wheat_per_person;
+    const int eat = std::min(wheat, static_cast<int>(std::ceil(eat_fraction * need)));
+    const int sell = static_cast<int>(sell_fraction * state.acres_);
+    const int budget = wheat - eat + sell * price;
+    const int buy = std::min(wheat / price, static_cast<int>(buy_fraction * budget / price));
+    return {std::max(0, buy), sell, 0, eat};
+}
+
+bool SameDecision(const UserInputData& a, const UserInputData& b) {
+    return a.acres_to_buy == b.acres_to_buy && a.acres_to_sell == b.acres_to_sell &&
+           a.wheat_to_plant == b.wheat_to_plant && a.wheat_to_eat == b.wheat_to_eat;
+}
+
+// Builds every decision of the menu for a state and price. Poor cities hit the caps of MakeDecision,
+// so several menu entries often come out the same; `first[i]` is the earliest entry equal to entry i,
+// which is the only one that needs playing out.
+void MakeDecisions(const GameState& state, const int price, UserInputData (&inputs)[kDecisions],
+                   int (&first)[kDecisions]) {
+    for (int decision = 0; decision < kDecisions; ++decision) {
+        inputs[decision] = MakeDecision(state, price, decision);
+        first[decision] = decision;
+        for (int earlier = 0; earlier < decision; ++earlier) {
+            if (SameDecision(inputs[earlier], inputs[decision])) {
+                first[decision] = earlier;
+                break;
+            }
+        }
+    }
+}
+
+struct Transition {
+    bool terminal;
+    GameResult result;
+    std::uint32_t cell;
+};
+
+Transition Apply(const GameState& state, const int deaths, const int price, const UserInputData& decision,
+                 const Outcome& outcome) {
+    const int rats = static_cast<int>(outcome.rats_fraction *
+                                      static_cast<int>(state.wheat_ * kRules.rats_wheat_consumption_fraction));
+    GameEngine engine(state, YearState{0, 0, outcome.plague, outcome.wheat_per_acre, rats, price, deaths});
+    engine.UpdateCityState(decision);
+    engine.ResolveYear();
+    if (engine.IsGameOver()) {
+        return {true, engine.CalculateResults(), 0};
+    }
+    return {false, GameResult::kRuined, CellOf(engine.game_state(), engine.total_starvation_deaths())};
+}
+
+void Mark(std::vector<std::uint64_t>& bits, const std::uint32_t cell) {
+    std::atomic_ref<std::uint64_t>(bits[cell / 64]).fetch_or(std::uint64_t{1} << cell % 64,
+                                                             std::memory_order_relaxed);
+}
+
+bool IsMarked(const std::vector<std::uint64_t>& bits, const std::uint32_t cell) {
+    return (bits[cell / 64] >> cell % 64) & 1;
+}
+
+// Nearest solved cell with the same starvation count, searched by growing
+// distance in population, acres and wheat levels.
+bool FindNearestMarked(const std::vector<std::uint64_t>& bits, const std::uint32_t cell, std::uint32_t& nearest) {
+    constexpr int kRadius = 3;
+    const int deaths = static_cast<int>(cell % kDeathLevels);
+    const int wheat = static_cast<int>(cell / kDeathLevels % kAmountLevels);
+    const int acres = static_cast<int>(cell / kDeathLevels / kAmountLevels % kAmountLevels);
+    const int population = static_cast<int>(cell / kDeathLevels / kAmountLevels / kAmountLevels);
+    for (int distance = 1; distance <= 3 * kRadius; ++distance) {
+        for (int dp = -kRadius; dp <= kRadius; ++dp) {
+            for (int da = -kRadius; da <= kRadius; ++da) {
+                const int dw_abs = distance - std::abs(dp) - std::abs(da);
+                if (dw_abs < 0 || dw_abs > kRadius) {
+                    continue;
+                }
+                for (const int dw : {-dw_abs, dw_abs}) {
+                    const int p = population + dp;
+                    const int a = acres + da;
+                    const int w = wheat + dw;
+                    if (p < 0 || p >= kPopulationLevels || a < 0 || a >= kAmountLevels || w < 0 ||
+                        w >= kAmountLevels) {
+                        continue;
+                    }
+                    const auto candidate = static_cast<std::uint32_t>(((p * kAmountLevels + a) * kAmountLevels + w) *
+                                                                      kDeathLevels + deaths);
+                    if (IsMarked(bits, candidate)) {
+                        nearest = candidate;
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+PolicySolver::PolicySolver(const SolverOptions& options)
+    : options_(options), root_year_(-1), root_state_(0), root_decision_(0), root_value_(0), evaluated_cells_(0) {
+}
+
+void PolicySolver::Solve(const GameEngine& engine) {
+    const WorkStealingPool pool(options_.threads);
+    const GameState& root = engine.game_state();
+    root_year_ = root.year_;
+    root_state_ = root;
+    layers_.assign(std::max(0, kRules.max_years - root_year_ - 1), Layer());
+    for (Layer& layer : layers_) {
+        layer.reachable.assign(kCells / 64 + 1, 0);
+    }
+    const int root_deaths = std::min(engine.total_starvation_deaths(), kDeathLevels - 1);
+    const int root_price = engine.land_price();
+
+    auto mark_successors = [](const GameState& state, const int deaths, const int price, const bool first_price,
+                              Layer* next) {
+        UserInputData inputs[kDecisions];
+        int first[kDecisions];
+        MakeDecisions(state, price, inputs, first);
+        for (int decision = 0; decision < kDecisions; ++decision) {
+            if ((!first_price && !DependsOnPrice(decision)) || first[decision] != decision) {
+                continue;
+            }
+            for (const Outcome& outcome : kOutcomes) {
+                const Transition transition = Apply(state, deaths, price, inputs[decision], outcome);
+                if (!transition.terminal) {
+                    Mark(next->reachable, transition.cell);
+                }
+            }
+        }
+    };
+
+    // Forward pass: which cells can be reached at all.
+    if (!layers_.empty()) {
+        mark_successors(root, root_deaths, root_price, true, &layers_[0]);
+    }
+    for (std::size_t t = 0; t < layers_.size(); ++t) {
+        Layer& layer = layers_[t];
+        for (std::uint32_t word = 0; word < layer.reachable.size(); ++word) {
+            for (std::uint64_t bits = layer.reachable[word]; bits != 0; bits &= bits - 1) {
+                layer.cells.push_back(word * 64 + std::countr_zero(bits));
+            }
+        }
+        if (t + 1 == layers_.size()) {
+            break;
+        }
+        Layer* next = &layers_[t + 1];
+        const int year = root_year_ + 1 + static_cast<int>(t);
+        const auto tasks = static_cast<std::uint32_t>((layer.cells.size() + kCellsPerTask - 1) / kCellsPerTask);
+        pool.Run(tasks, [&](unsigned, const std::uint32_t task) {
+            const std::size_t end = std::min(layer.cells.size(), (task + 1) * std::size_t{kCellsPerTask});
+            for (std::size_t i = task * std::size_t{kCellsPerTask}; i < end; ++i) {
+                int deaths;
+                const GameState state = StateOf(layer.cells[i], year, deaths);
+                for (int band = 0; band < kPriceBandCount; ++band) {
+                    mark_successors(state, deaths, kPriceBands[band].price, band == 0, next);
+                }
+            }
+        });
+    }
+
+    // Backward pass: expected score of the best decision, year by year.
+    auto expected_value = [this](const GameState& state, const int deaths, const int price,
+                                 const UserInputData& input, const Layer* next) {
+        double value = 0;
+        for (const Outcome& outcome : kOutcomes) {
+            const Transition transition = Apply(state, deaths, price, input, outcome);
+            value += outcome.probability * (transition.terminal
+                                                ? options_.result_scores[static_cast<int>(transition.result)]
+                                                : next->values[transition.cell]);
+        }
+        return value;
+    };
+
+    evaluated_cells_ = 0;
+    for (std::size_t t = layers_.size(); t-- > 0;) {
+        Layer& layer = layers_[t];
+        const Layer* next = t + 1 < layers_.size() ? &layers_[t + 1] : nullptr;
+        const int year = root_year_ + 1 + static_cast<int>(t);
+        layer.values.assign(kCells, 0.0f);
+        layer.decisions.assign(layer.cells.size() * kPriceBandCount, 0);
+        evaluated_cells_ += layer.cells.size();
+
+        const auto tasks = static_cast<std::uint32_t>((layer.cells.size() + kCellsPerTask - 1) / kCellsPerTask);
+        pool.Run(tasks, [&](unsigned, const std::uint32_t task) {
+            const std::size_t end = std::min(layer.cells.size(), (task + 1) * std::size_t{kCellsPerTask});
+            for (std::size_t i = task * std::size_t{kCellsPerTask}; i < end; ++i) {
+                int deaths;
+                const GameState state = StateOf(layer.cells[i], year, deaths);
+                double cell_value = 0;
+                double values[kDecisions];
+                UserInputData inputs[kDecisions];
+                int first[kDecisions];
+                for (int band = 0; band < kPriceBandCount; ++band) {
+                    MakeDecisions(state, kPriceBands[band].price, inputs, first);
+                    double best = -std::numeric_limits<double>::infinity();
+                    for (int decision = 0; decision < kDecisions; ++decision) {
+                        // Price-free entries keep their value from the first band.
+                        if (band == 0 || DependsOnPrice(decision)) {
+                            values[decision] = first[decision] != decision
+                                                   ? values[first[decision]]
+                                                   : expected_value(state, deaths, kPriceBands[band].price,
+                                                                    inputs[decision], next);
+                        }
+                        const double value = values[decision];
+                        if (value > best) {
+                            best = value;
+                            layer.decisions[i * kPriceBandCount + band] = static_cast<std::uint8_t>(decision);
+                        }
+                    }
+                    cell_value += kPriceBands[band].probability * best;
+                }
+                layer.values[layer.cells[i]] = static_cast<float>(cell_value);
+            }
+        });
+        if (next != nullptr) {
+            layers_[t + 1].values = std::vector<float>();
+        }
+    }
+
+    root_value_ = -std::numeric_limits<double>::infinity();
+    const Layer* first = layers_.empty() ? nullptr : &layers_[0];
+    for (int decision = 0; decision < kDecisions; ++decision) {
+        const UserInputData input = MakeDecision(root, root_price, decision);
+        const double value = expected_value(root, root_deaths, root_price, input, first);
+        if (value > root_value_) {
+            root_value_ = value;
+            root_decision_ = decision;
+        }
+    }
+    if (first != nullptr) {
+        layers_[0].values = std::vector<float>();
+    }
+}
+
+UserInputData PolicySolver::BestDecision(const GameEngine& engine) {
+    const GameState& state = engine.game_state();
+    const int price = engine.land_price();
+    const std::size_t t = static_cast<std::size_t>(state.year_ - root_year_ - 1);
+    if (root_year_ >= 0 && state.year_ > root_year_ && t < layers_.size()) {
+        const Layer& layer = layers_[t];
+        std::uint32_t cell = CellOf(state, engine.total_starvation_deaths());
+        if (IsMarked(layer.reachable, cell) || FindNearestMarked(layer.reachable, cell, cell)) {
+            const auto position = std::lower_bound(layer.cells.begin(), layer.cells.end(), cell) - layer.cells.begin();
+            const int decision = layer.decisions[position * kPriceBandCount + PriceBandOf(price)];
+            return engine.ClampDecision(MakeDecision(state, price, decision));
+        }
+    }
+    if (state.year_ != root_year_ || state.population_ != root_state_.population_ ||
+        state.acres_ != root_state_.acres_ || state.wheat_ != root_state_.wheat_) {
+        Solve(engine);
+    }
+    return engine.ClampDecision(MakeDecision(state, price, root_decision_));
+}
@@ -0,0 +1,63 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "monte_carlo.h"
+#include "../game/game_engine.h"
+
+struct SolverOptions {
+    unsigned threads = std::thread::hardware_concurrency();
+    // Score of every verdict tier; the solver maximises its expectation.
+    std::array<double, kGameResultCount> result_scores = {0, 1, 2, 3, 4, 5};
+};
+
+// Expected-score-maximising decisions by backward induction.
+//
+// Years after the current one are solved over a grid of (population, acres,
+// wheat, starvation deaths so far) cells: population in steps of 20, acres and
+// wheat in half-octave steps, deaths as 0..3 or "4 or more", which is all
+// CalculateResults can tell apart. Land price is seen before deciding and the
+// yield, rats and plague are not, so every cell keeps one best decision per
+// price band and averages over the hidden draws. A decision is picked from a
+// small menu of fractions: how much of the grain the people need to feed them,
+// how much of the remaining budget to spend on land, and how much land to sell.
+//
+// Only cells reachable from the starting state are evaluated, and every year's
+// layer is split across threads. The solver plays by the stock rules.
+class PolicySolver {
+ public:
+    explicit PolicySolver(const SolverOptions& options = SolverOptions());
+
+    // Solves the rest of the reign from the engine's current year and state.
+    void Solve(const GameEngine& engine);
+
+    [[nodiscard]] double ExpectedScore() const { return root_value_; }
+    [[nodiscard]] std::uint64_t EvaluatedCells() const { return evaluated_cells_; }
+
+    // Best decision for the engine's year, state and land price, taken from the
+    // nearest solved cell. Re-solves from the engine if play has drifted away
+    // from every cell covered by the last Solve.
+    UserInputData BestDecision(const GameEngine& engine);
+
+ private:
+    struct Layer {
+        std::vector<std::uint64_t> reachable;
+        std::vector<std::uint32_t> cells;
+        std::vector<float> values;
+        std::vector<std::uint8_t> decisions;
+    };
+
+    SolverOptions options_;
+    int root_year_;
+    GameState root_state_;
+    int root_decision_;
+    double root_value_;
+    std::uint64_t evaluated_cells_;
+    // layers_[year - root_year_ - 1] covers the decision made in `year`.
+    std::vector<Layer> layers_;
+};
@@ -0,0 +1,115 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Runs a range of independent tasks on a fixed number of threads. Every worker
+// starts with an equal slice of the range and, once it runs dry, steals the
+// upper half of the largest slice left to another worker. Slices are packed
+// [begin, end) pairs in one atomic word, so neither owners nor thieves lock.
+class WorkStealingPool {
+ public:
+    explicit WorkStealingPool(unsigned threads = std::thread::hardware_concurrency())
+        : threads_(std::max(1u, threads)) {}
+
+    [[nodiscard]] unsigned threads() const { return threads_; }
+
+    // Calls fn(worker, task) for every task in [0, tasks); worker is in [0, threads()).
+    template<typename Fn>
+    void Run(std::uint32_t tasks, Fn&& fn) const;
+
+ private:
+    struct alignas(64) Slice {
+        std::atomic<std::uint64_t> range;
+    };
+
+    static constexpr std::uint64_t Pack(const std::uint32_t begin, const std::uint32_t end) {
+        return static_cast<std::uint64_t>(begin) << 32 | end;
+    }
+    static constexpr std::uint32_t Begin(const std::uint64_t range) { return range >> 32; }
+    static constexpr std::uint32_t End(const std::uint64_t range) { return range & 0xFFFFFFFFu; }
+
+    static bool PopFront(Slice& slice, std::uint32_t& task);
+    static bool StealHalf(Slice* slices, unsigned count, Slice& own);
+
+    unsigned threads_;
+};
+
+template<typename Fn>
+void WorkStealingPool::Run(const std::uint32_t tasks, Fn&& fn) const {
+    const unsigned workers = std::min<std::uint32_t>(threads_, std::max(1u, tasks));
+    const std::unique_ptr<Slice[]> slices(new Slice[workers]);
+    for (unsigned i = 0; i < workers; ++i) {
+        const auto begin = static_cast<std::uint32_t>(static_cast<std::uint64_t>(tasks) * i / workers);
+        const auto end = static_cast<std::uint32_t>(static_cast<std::uint64_t>(tasks) * (i + 1) / workers);
+        slices[i].range.store(Pack(begin, end), std::memory_order_relaxed);
+    }
+
+    auto work = [&](const unsigned worker) {
+        Slice& own = slices[worker];
+        std::uint32_t task;
+        do {
+            while (PopFront(own, task)) {
+                fn(worker, task);
+            }
+        } while (StealHalf(slices.get(), workers, own));
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (unsigned i = 1; i < workers; ++i) {
+        pool.emplace_back(work, i);
+    }
+    work(0);
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+}
+
+inline bool WorkStealingPool::PopFront(Slice& slice, std::uint32_t& task) {
+    std::uint64_t range = slice.range.load(std::memory_order_acquire);
+    while (Begin(range) < End(range)) {
+        if (slice.range.compare_exchange_weak(range, Pack(Begin(range) + 1, End(range)),
+                                              std::memory_order_acq_rel)) {
+            task = Begin(range);
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool WorkStealingPool::StealHalf(Slice* slices, const unsigned count, Slice& own) {
+    while (true) {
+        Slice* victim = nullptr;
+        std::uint64_t victim_range = 0;
+        std::uint32_t largest = 0;
+        for (unsigned i = 0; i < count; ++i) {
+            const std::uint64_t range = slices[i].range.load(std::memory_order_acquire);
+            if (End(range) > Begin(range) && End(range) - Begin(range) > largest) {
+                largest = End(range) - Begin(range);
+                victim = &slices[i];
+                victim_range = range;
+            }
+        }
+        if (victim == nullptr) {
+            return false;
+        }
+        // The last task of a slice is left to its owner.
+        if (largest < 2) {
+            std::this_thread::yield();
+            continue;
+        }
+        const std::uint32_t middle = Begin(victim_range) + largest / 2;
+        if (victim->range.compare_exchange_strong(victim_range, Pack(Begin(victim_range), middle),
+                                                  std::memory_order_acq_rel)) {
+            own.range.store(Pack(middle, End(victim_range)), std::memory_order_release);
+            return true;
+        }
+    }
+}
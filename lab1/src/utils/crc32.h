@@ -0,0 +1,10 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC-32 (IEEE, as in zip and PNG) of `size` bytes, one table lookup per byte. Continues from
+// `crc`, the result for the bytes before, so a checksum can be taken over several ranges.
+std::uint32_t Crc32(const void* data, std::size_t size, std::uint32_t crc = 0);
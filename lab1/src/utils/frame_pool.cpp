@@ -0,0 +1,65 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include "frame_pool.h"
+
+#include <array>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t kSizeClasses = FramePool::kMaxBlockSize / FramePool::kAlignment;
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+struct ThreadPool {
+    std::array<FreeBlock*, kSizeClasses> free_lists{};
+    std::vector<std::unique_ptr<std::byte[]>> chunks;
+    std::byte* chunk_position = nullptr;
+    std::size_t chunk_left = 0;
+
+    void* Carve(const std::size_t block_size) {
+        if (chunk_left < block_size) {
+            // The tail of the old chunk is too small for this class; it is simply left unused.
+            chunks.push_back(std::make_unique<std::byte[]>(FramePool::kChunkSize));
+            chunk_position = chunks.back().get();
+            chunk_left = FramePool::kChunkSize;
+        }
+        void* block = chunk_position;
+        chunk_position += block_size;
+        chunk_left -= block_size;
+        return block;
+    }
+};
+
+thread_local ThreadPool pool;
+
+std::size_t SizeClass(const std::size_t size) {
+    return (size + FramePool::kAlignment - 1) / FramePool::kAlignment - 1;
+}
+
+}  // namespace
+
+void* FramePool::Allocate(const std::size_t size) {
+    if (size == 0 || size > kMaxBlockSize) {
+        return ::operator new(size);
+    }
+    const std::size_t size_class = SizeClass(size);
+    if (FreeBlock* block = pool.free_lists[size_class]) {
+        pool.free_lists[size_class] = block->next;
+        return block;
+    }
+    return pool.Carve((size_class + 1) * kAlignment);
+}
+
+void FramePool::Deallocate(void* block, const std::size_t size) {
+    if (size == 0 || size > kMaxBlockSize) {
+        ::operator delete(block);
+        return;
+    }
+    const std::size_t size_class = SizeClass(size);
+    pool.free_lists[size_class] = ::new (block) FreeBlock{pool.free_lists[size_class]};
+}
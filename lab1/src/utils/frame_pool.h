@@ -0,0 +1,20 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#pragma once
+
+#include <cstddef>
+
+// Fixed-size blocks for coroutine frames. Every frame of one coroutine has the same size, so
+// each thread keeps a free list per size class (multiples of kAlignment up to kMaxBlockSize)
+// and refills it from kChunkSize chunks; bigger frames go to operator new. A freed block goes
+// on the freeing thread's list. Chunks are released when their thread exits, so frames must
+// not outlive the thread that allocated them.
+class FramePool {
+ public:
+    static constexpr std::size_t kAlignment = 16;
+    static constexpr std::size_t kMaxBlockSize = 1024;
+    static constexpr std::size_t kChunkSize = 64 * 1024;
+
+    static void* Allocate(std::size_t size);
+    static void Deallocate(void* block, std::size_t size);
+};
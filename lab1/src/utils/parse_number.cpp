@@ -0,0 +1,46 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include "parse_number.h"
+
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+
+bool ParseNumber(const char* text, const int min, int& value) {
+    char* end = nullptr;
+    errno = 0;
+    const long parsed = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno != 0 || parsed < min || parsed > INT_MAX) {
+        return false;
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+bool ParseNumber(const char* text, const std::uint64_t min, std::uint64_t& value) {
+    // strtoull negates a leading minus sign instead of rejecting it.
+    if (!std::isdigit(static_cast<unsigned char>(*text))) {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    const unsigned long long parsed = std::strtoull(text, &end, 10);
+    if (*end != '\0' || errno != 0 || parsed < min) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+bool ParseNumber(const char* text, const float min, float& value) {
+    char* end = nullptr;
+    errno = 0;
+    const float parsed = std::strtof(text, &end);
+    if (end == text || *end != '\0' || errno != 0 || !std::isfinite(parsed) || parsed < min) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
@@ -0,0 +1,11 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#pragma once
+
+#include <cstdint>
+
+// Command-line numbers: the whole of `text` as a number of at least `min`, false for anything
+// else. atoi and strtoull would read a typo as 0 and "-1" as a huge count.
+bool ParseNumber(const char* text, int min, int& value);
+bool ParseNumber(const char* text, std::uint64_t min, std::uint64_t& value);
+bool ParseNumber(const char* text, float min, float& value);
@@ -0,0 +1,54 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include "random.h"
+
+#include <random>
+
+Random::Random(): Random(static_cast<std::uint64_t>(std::random_device{}()) << 32 | std::random_device{}()) {}
+
+Random::Random(const std::uint64_t seed) {
+    Seed(seed);
+}
+
+void Random::Seed(std::uint64_t seed) {
+    for (std::uint64_t& word : state_) {
+        seed += 0x9E3779B97F4A7C15ull;
+        word = SplitMix64(seed);
+    }
+}
+
+void Random::Jump() {
+    constexpr std::uint64_t kJump[] = {0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull,
+                                       0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull};
+    std::uint64_t jumped[4] = {0, 0, 0, 0};
+    for (const std::uint64_t word : kJump) {
+        for (int bit = 0; bit < 64; ++bit) {
+            if (word & std::uint64_t{1} << bit) {
+                for (int i = 0; i < 4; ++i) {
+                    jumped[i] ^= state_[i];
+                }
+            }
+            Next();
+        }
+    }
+    for (int i = 0; i < 4; ++i) {
+        state_[i] = jumped[i];
+    }
+}
+
+void Random::Fill(std::uint64_t* out, const std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = Next();
+    }
+}
+
+void Random::FillInRange(int* out, const std::size_t count, const int min, const int max) {
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = NextInRange(min, max);
+    }
+}
+
+Random& ThreadRandom() {
+    thread_local Random random;
+    return random;
+}
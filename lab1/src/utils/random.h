@@ -0,0 +1,78 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+constexpr std::uint64_t SplitMix64(std::uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ x >> 30) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ x >> 27) * 0x94D049BB133111EBull;
+    return x ^ x >> 31;
+}
+
+// xoshiro256** generator. The same seed always produces the same sequence,
+// and Jump() splits off non-overlapping streams of 2^128 numbers.
+class Random {
+ public:
+    using result_type = std::uint64_t;
+
+    Random();
+    explicit Random(std::uint64_t seed);
+
+    void Seed(std::uint64_t seed);
+    void Jump();
+
+    result_type Next() {
+        const std::uint64_t result = Rotl(state_[1] * 5, 7) * 9;
+        const std::uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = Rotl(state_[3], 45);
+        return result;
+    }
+
+    // Uniform integer in [min, max] (Lemire's multiply-shift with rejection). An empty range has no
+    // answer: max < min would wrap around to a range of nearly 2^32 values. The arithmetic is done
+    // in uint32_t, where [INT_MIN, INT_MAX] and its offsets wrap instead of overflowing.
+    int NextInRange(const int min, const int max) {
+        assert(min <= max);
+        const auto base = static_cast<std::uint32_t>(min);
+        const std::uint32_t range = static_cast<std::uint32_t>(max) - base + 1;
+        if (range == 0) {
+            return static_cast<int>(base + static_cast<std::uint32_t>(Next() >> 32));
+        }
+        std::uint64_t product = (Next() >> 32) * range;
+        if (static_cast<std::uint32_t>(product) < range) {
+            const std::uint32_t threshold = -range % range;
+            while (static_cast<std::uint32_t>(product) < threshold) {
+                product = (Next() >> 32) * range;
+            }
+        }
+        return static_cast<int>(base + static_cast<std::uint32_t>(product >> 32));
+    }
+
+    void Fill(std::uint64_t* out, std::size_t count);
+    // NextInRange for `count` numbers; the same precondition holds.
+    void FillInRange(int* out, std::size_t count, int min, int max);
+
+    result_type operator()() { return Next(); }
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+ private:
+    std::uint64_t state_[4];
+
+    static constexpr std::uint64_t Rotl(const std::uint64_t x, const int k) {
+        return x << k | x >> (64 - k);
+    }
+};
+
+// Generator of the calling thread, seeded from std::random_device on first use.
+Random& ThreadRandom();
@@ -1,12 +1,9 @@
 // Copyright 2024 Sergo Elizbarashvili
 
 #pragma once
-#include <random>
+#include <cstdint>
 
 int RandomInRange(int min, int max);
 
-int ValidateInput(int min, int max, const std::string& prompt);
-
-
-
-
+// Reseeds the calling thread's RandomInRange stream.
+void SeedRandom(std::uint64_t seed);
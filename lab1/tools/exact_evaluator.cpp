@@ -0,0 +1,75 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "../src/simulation/exact_distribution.h"
+#include "../src/utils/parse_number.h"
+
+namespace {
+
+// Grain grid of a run that does not give one, where a grid of 1 would not finish. It does not bound
+// the run: the cost depends on how many cities the policy keeps apart, from 2.3 G transitions
+// (3.5 s on one core) for "0 0 1000 2000" to 17.7 G (40 s) for "5 0 0 2000". Results at this step
+// are an approximation, and strategy_evaluator gets close to them with far less work.
+constexpr int kDefaultWheatStep = 50;
+
+const char* const kResultNames[kGameResultCount] = {
+    "ruined", "starvation", "exiled", "iron fist", "average", "fantastic",
+};
+
+template<std::size_t Bins>
+void PrintDistribution(const char* title, const std::array<double, Bins>& distribution, const int bin_width) {
+    std::cout << title << ":\n";
+    for (std::size_t i = 0; i < Bins; ++i) {
+        if (distribution[i] == 0) {
+            continue;
+        }
+        std::cout << "  " << i * bin_width << (i + 1 == Bins ? "+" : "") << '\t' << 100.0 * distribution[i] << "%\n";
+    }
+}
+
+}  // namespace
+
+// The exact counterpart of strategy_evaluator: the same tables, as probabilities instead of counts.
+int main(const int argc, char* argv[]) {
+    UserInputData policy;
+    ExactOptions options;
+    options.wheat_step = kDefaultWheatStep;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    if (argc < 5 || !ParseNumber(argv[1], 0, policy.acres_to_buy) || !ParseNumber(argv[2], 0, policy.acres_to_sell) ||
+        !ParseNumber(argv[3], 0, policy.wheat_to_plant) || !ParseNumber(argv[4], 0, policy.wheat_to_eat) ||
+        (argc > 5 && !ParseNumber(argv[5], 1, options.wheat_step)) || (argc > 6 && !ParseNumber(argv[6], 1, threads))) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <acres_to_buy> <acres_to_sell> <wheat_to_plant> <wheat_to_eat> [wheat_step] [threads]"
+                     " [rules_file]\n"
+                  << "The amounts are whole numbers of at least 0, the wheat step (default " << kDefaultWheatStep
+                  << ", 1 is exact) and the threads at least 1.\n";
+        return 1;
+    }
+    options.threads = static_cast<unsigned>(threads);
+    Ruleset rules;
+    if (argc > 7 && !LoadRuleset(argv[7], rules)) {
+        std::cerr << "Invalid rules file " << argv[7] << '\n';
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const ExactResult result = EvaluatePolicyExactly(policy, options, argc > 7 ? &rules : nullptr);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << result.transitions << " transitions in " << elapsed.count() << " s\n";
+    std::cout << "Cities per year:";
+    for (const std::size_t states : result.states_per_year) {
+        std::cout << ' ' << states;
+    }
+    std::cout << '\n';
+    std::cout << "Results:\n";
+    for (int i = 0; i < kGameResultCount; ++i) {
+        std::cout << "  " << kResultNames[i] << '\t' << 100.0 * result.results[i] << "%\n";
+    }
+    PrintDistribution("Population", result.population, 10);
+    PrintDistribution("Acres per person", result.acres_per_person, 1);
+}
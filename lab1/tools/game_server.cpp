@@ -0,0 +1,70 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include <csignal>
+#include <iostream>
+
+#include <sys/resource.h>
+
+#include "../src/file_system/autosave_journal.h"
+#include "../src/file_system/file_manager.h"
+#include "../src/leaderboard/leaderboard.h"
+#include "../src/server/game_server.h"
+
+namespace {
+
+GameServer* server = nullptr;
+
+void StopServer(int) {
+    server->Stop();
+}
+
+// Every session holds a descriptor, so take as many as we are allowed.
+void RaiseDescriptorLimit() {
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+}  // namespace
+
+// Serves games until SIGINT or SIGTERM; try it with `socat - UNIX-CONNECT:<socket_path>`.
+int main(const int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <socket_path> [save_directory]\n";
+        return 1;
+    }
+    if (argc > 2) {
+        FileManager::SetSaveDirectory(argv[2]);
+    }
+    RaiseDescriptorLimit();
+    Leaderboard leaderboard;
+    if (!leaderboard.Open((FileManager::SaveDirectory() / "leaderboard.dat").string())) {
+        std::cerr << "Cannot open the leaderboard, finished reigns are not kept\n";
+    }
+    // Games a crash cut short become saves again before anyone can ask for them.
+    AutosaveJournal journal;
+    if (!journal.Open(FileManager::SaveDirectory() / "autosave.journal")) {
+        std::cerr << "Cannot open the autosave journal, games are not journaled\n";
+    } else if (!journal.RestoreSaves()) {
+        std::cerr << "Cannot restore every journaled game\n";
+    }
+    GameServer game_server(argv[1]);
+    game_server.SetLeaderboard(&leaderboard);
+    game_server.SetJournal(&journal);
+    if (!game_server.Open()) {
+        std::cerr << "Cannot listen on " << argv[1] << '\n';
+        return 1;
+    }
+    server = &game_server;
+    std::signal(SIGINT, StopServer);
+    std::signal(SIGTERM, StopServer);
+    const bool served = game_server.Run();
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    server = nullptr;
+    leaderboard.Flush();
+    journal.Sync();
+    return served ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "../src/simulation/monte_carlo.h"
+#include "../src/utils/parse_number.h"
+
+namespace {
+
+constexpr int kScores[kGameResultCount] = {0, 1, 2, 3, 4, 5};
+
+}  // namespace
+
+// Usage: hammurabi_sim <policies_file> [games] [seed] [threads] [rules_file]
+// Plays every policy of the file, one "acres_to_buy acres_to_sell wheat_to_plant wheat_to_eat" line
+// each ('#' starts a comment), for the same games, and prints a tab-separated row per policy:
+// the policy, the share of every verdict, the mean score (0 ruined ... 5 fantastic) and the speed.
+int main(const int argc, char* argv[]) {
+    std::uint64_t games = 100000;
+    std::uint64_t seed = 0;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    if (argc < 2 || (argc > 2 && !ParseNumber(argv[2], 1, games)) || (argc > 3 && !ParseNumber(argv[3], 0, seed)) ||
+        (argc > 4 && !ParseNumber(argv[4], 1, threads))) {
+        std::cerr << "Usage: " << argv[0] << " <policies_file> [games] [seed] [threads] [rules_file]\n"
+                  << "The seed is a whole number of at least 0, the games and the threads at least 1.\n";
+        return 1;
+    }
+    std::ifstream policies(argv[1]);
+    if (!policies) {
+        std::cerr << "Cannot open " << argv[1] << '\n';
+        return 1;
+    }
+    Ruleset rules;
+    if (argc > 5 && !LoadRuleset(argv[5], rules)) {
+        std::cerr << "Invalid rules file " << argv[5] << '\n';
+        return 1;
+    }
+
+    std::cout << "buy\tsell\tplant\teat\truined\tstarvation\texiled\tiron fist\taverage\tfantastic\tscore\tgames/s\n";
+    std::string line;
+    for (int number = 1; std::getline(policies, line); ++number) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        UserInputData policy;
+        if (!(fields >> policy.acres_to_buy)) {
+            continue;
+        }
+        if (!(fields >> policy.acres_to_sell >> policy.wheat_to_plant >> policy.wheat_to_eat)) {
+            std::cerr << argv[1] << ':' << number << ": expected four numbers\n";
+            return 1;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const MonteCarloResult result =
+            EvaluatePolicy(policy, games, seed, static_cast<unsigned>(threads), argc > 5 ? &rules : nullptr);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << policy.acres_to_buy << '\t' << policy.acres_to_sell << '\t' << policy.wheat_to_plant << '\t'
+                  << policy.wheat_to_eat;
+        double score = 0;
+        for (int i = 0; i < kGameResultCount; ++i) {
+            const double share = static_cast<double>(result.results.counts[i]) / static_cast<double>(result.games);
+            score += kScores[i] * share;
+            std::cout << '\t' << 100.0 * share << '%';
+        }
+        std::cout << '\t' << score << '\t' << static_cast<double>(result.games) / elapsed.count() << '\n';
+    }
+}
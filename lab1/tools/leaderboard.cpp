@@ -0,0 +1,124 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../src/leaderboard/leaderboard.h"
+#include "../src/simulation/city_batch.h"
+#include "../src/simulation/monte_carlo.h"
+#include "../src/utils/parse_number.h"
+
+namespace {
+
+constexpr const char* kResultNames[kGameResultCount] = {"ruined",   "starvation", "exiled",
+                                                        "iron fist", "average",    "fantastic"};
+constexpr std::size_t kBatchSize = 4096;
+constexpr int kRankQueries = 1000000;
+
+void PrintReign(const std::size_t place, const ReignRecord& reign) {
+    std::cout << place << '\t' << kResultNames[reign.result] << '\t' << reign.acres_per_person << '\t'
+              << reign.average_starvation << '\t' << reign.population << '\t' << reign.seed << '\t' << reign.player_id
+              << '\n';
+}
+
+// Plays `games` reigns of one policy and records every one of them; false if the file cannot be written.
+bool Add(Leaderboard& leaderboard, const UserInputData& policy, const std::uint64_t games, const std::uint64_t seed) {
+    const auto start = std::chrono::steady_clock::now();
+    CityBatch cities;
+    for (std::uint64_t first = 0; first < games; first += kBatchSize) {
+        const auto count = static_cast<std::size_t>(std::min<std::uint64_t>(kBatchSize, games - first));
+        cities.Reset(seed, first, count);
+        cities.PlayReign(policy);
+        for (std::size_t i = 0; i < count; ++i) {
+            if (!leaderboard.Record(cities.City(i))) {
+                return false;
+            }
+        }
+    }
+    if (!leaderboard.Flush()) {
+        return false;
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "recorded " << games << " reigns in " << elapsed.count() << " s, " << leaderboard.size()
+              << " in total\n";
+    return true;
+}
+
+void Rank(const Leaderboard& leaderboard, const ReignRecord& reign) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRankQueries; ++i) {
+        ReignRecord query = reign;
+        query.population += i & 1;
+        static_cast<void>(leaderboard.Rank(query));
+    }
+    const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "rank " << leaderboard.Rank(reign) << " of " << leaderboard.size() << ", percentile "
+              << leaderboard.Percentile(reign) << ", " << elapsed.count() / kRankQueries << " us per query\n";
+}
+
+}  // namespace
+
+// Usage:
+//   leaderboard <file> add <buy> <sell> <plant> <eat> [games] [seed]
+//   leaderboard <file> top [count]
+//   leaderboard <file> rank <result> <acres_per_person> <average_starvation> <population>
+// `add` plays a fixed policy and records every reign, `top` prints the best reigns and `rank` places a
+// reign (result 0 ruined ... 5 fantastic) among the recorded ones and times the query.
+int main(const int argc, char* argv[]) {
+    // The arguments are checked before the leaderboard file is opened, which creates it.
+    UserInputData policy;
+    std::uint64_t games = 1000000;
+    std::uint64_t seed = 0;
+    std::uint64_t count = 10;
+    ReignRecord reign{};
+    const char* command = argc >= 3 ? argv[2] : "";
+    bool valid = false;
+    if (std::strcmp(command, "add") == 0) {
+        valid = argc >= 7 && ParseNumber(argv[3], 0, policy.acres_to_buy) &&
+                ParseNumber(argv[4], 0, policy.acres_to_sell) && ParseNumber(argv[5], 0, policy.wheat_to_plant) &&
+                ParseNumber(argv[6], 0, policy.wheat_to_eat) && (argc <= 7 || ParseNumber(argv[7], 1, games)) &&
+                (argc <= 8 || ParseNumber(argv[8], 0, seed));
+    } else if (std::strcmp(command, "top") == 0) {
+        valid = argc <= 3 || ParseNumber(argv[3], 0, count);
+    } else if (std::strcmp(command, "rank") == 0) {
+        valid = argc >= 7 && ParseNumber(argv[3], 0, reign.result) && reign.result < kGameResultCount &&
+                ParseNumber(argv[4], 0.0f, reign.acres_per_person) &&
+                ParseNumber(argv[5], 0.0f, reign.average_starvation) && ParseNumber(argv[6], 0, reign.population);
+    }
+    if (!valid) {
+        std::cerr << "Usage: " << argv[0] << " <file> add <buy> <sell> <plant> <eat> [games] [seed]\n"
+                  << "       " << argv[0] << " <file> top [count]\n"
+                  << "       " << argv[0]
+                  << " <file> rank <result> <acres_per_person> <average_starvation> <population>\n"
+                  << "The numbers are at least 0, the games at least 1 and the result at most "
+                  << kGameResultCount - 1 << ".\n";
+        return 1;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    Leaderboard leaderboard;
+    if (!leaderboard.Open(argv[1])) {
+        std::cerr << "Cannot open " << argv[1] << '\n';
+        return 1;
+    }
+    const std::chrono::duration<double> opened = std::chrono::steady_clock::now() - start;
+    std::cerr << "indexed " << leaderboard.size() << " reigns in " << opened.count() << " s\n";
+
+    if (std::strcmp(command, "add") == 0) {
+        if (!Add(leaderboard, policy, games, seed)) {
+            std::cerr << "Cannot write " << argv[1] << '\n';
+            return 1;
+        }
+    } else if (std::strcmp(command, "top") == 0) {
+        const std::vector<ReignRecord> top = leaderboard.Top();
+        std::cout << "place\tresult\tacres/person\tstarvation/year\tpopulation\tseed\tplayer\n";
+        for (std::size_t i = 0; i < top.size() && i < count; ++i) {
+            PrintReign(i + 1, top[i]);
+        }
+    } else {
+        Rank(leaderboard, reign);
+    }
+}
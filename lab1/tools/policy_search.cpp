@@ -0,0 +1,55 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include <chrono>
+#include <iostream>
+
+#include "../src/simulation/policy_search.h"
+#include "../src/utils/parse_number.h"
+#include "../src/utils/random.h"
+
+namespace {
+
+void PrintStrategy(const Strategy& strategy) {
+    std::cout << "feed " << strategy.feed << ", plant " << strategy.plant << ", buy " << strategy.buy_share
+              << " at <= " << strategy.buy_price << ", sell " << strategy.sell_share << " at >= " << strategy.sell_price
+              << '\n';
+}
+
+}  // namespace
+
+// Usage: policy_search [population] [games] [generations] [threads] [seed]
+// Evolves strategies and checks the best one against fresh games.
+int main(const int argc, char* argv[]) {
+    SearchOptions options;
+    int generations = 20;
+    int threads = 1;
+    if ((argc > 1 && !ParseNumber(argv[1], 1, options.population)) ||
+        (argc > 2 && !ParseNumber(argv[2], 1, options.games)) || (argc > 3 && !ParseNumber(argv[3], 1, generations)) ||
+        (argc > 4 && !ParseNumber(argv[4], 1, threads)) || (argc > 5 && !ParseNumber(argv[5], 0, options.seed))) {
+        std::cerr << "Usage: " << argv[0] << " [population] [games] [generations] [threads] [seed]\n"
+                  << "The seed is a whole number of at least 0, the others at least 1.\n";
+        return 1;
+    }
+    if (argc > 4) {
+        options.threads = static_cast<unsigned>(threads);
+    }
+
+    PolicySearch search(options);
+    const auto start = std::chrono::steady_clock::now();
+    for (int generation = 0; generation < generations; ++generation) {
+        const auto generation_start = std::chrono::steady_clock::now();
+        search.RunGeneration();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - generation_start;
+        std::cout << "Generation " << generation << ": best " << search.best_score() << ", mean "
+                  << search.mean_score() << " (" << static_cast<double>(options.population * options.games) /
+                                                         elapsed.count() << " games/s)\n";
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Searched in " << elapsed.count() << " s\nBest: ";
+    PrintStrategy(search.best());
+
+    // Fresh games, none of which the search has seen.
+    constexpr std::uint64_t kCheckGames = 1000000;
+    std::cout << "Score over " << kCheckGames << " fresh games: "
+              << search.Evaluate(search.best(), kCheckGames, SplitMix64(options.seed) + 1) << '\n';
+}
@@ -0,0 +1,47 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include <chrono>
+#include <iostream>
+
+#include "../src/simulation/policy_solver.h"
+#include "../src/utils/parse_number.h"
+#include "../src/utils/random.h"
+
+int main(const int argc, char* argv[]) {
+    int games = 1000;
+    int threads = 1;
+    if ((argc > 1 && !ParseNumber(argv[1], 0, games)) || (argc > 2 && !ParseNumber(argv[2], 1, threads))) {
+        std::cerr << "Usage: " << argv[0] << " [games] [threads]\n"
+                  << "The games are a whole number of at least 0, the threads at least 1.\n";
+        return 1;
+    }
+    SolverOptions options;
+    if (argc > 2) {
+        options.threads = static_cast<unsigned>(threads);
+    }
+    PolicySolver solver(options);
+
+    GameEngine engine(GameState(0));
+    engine.GenerateRandomParams();
+    const auto start = std::chrono::steady_clock::now();
+    solver.Solve(engine);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const UserInputData first = solver.BestDecision(engine);
+    std::cout << "Solved " << solver.EvaluatedCells() << " cells in " << elapsed.count() * 1000 << " ms\n"
+              << "Expected score: " << solver.ExpectedScore() << '\n'
+              << "First year: buy " << first.acres_to_buy << ", sell " << first.acres_to_sell << ", plant "
+              << first.wheat_to_plant << ", eat " << first.wheat_to_eat << '\n';
+
+    // Plays the solver's policy to check the expectation against real games.
+    double total = 0;
+    for (int game = 0; game < games; ++game) {
+        GameEngine reign(GameState(SplitMix64(game + 1)));
+        const GameResult result = reign.PlayReign([&solver](const GameEngine& state) {
+            return solver.BestDecision(state);
+        });
+        total += options.result_scores[static_cast<int>(result)];
+    }
+    if (games > 0) {
+        std::cout << "Average score over " << games << " games: " << total / games << '\n';
+    }
+}
@@ -0,0 +1,37 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+#include "../src/replay/replay_log.h"
+
+int main(const int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <replay.log>...\n";
+        return 1;
+    }
+    std::uint64_t sessions = 0;
+    std::uint64_t mismatches = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 1; i < argc; ++i) {
+        ReplayLogReader reader(argv[i]);
+        if (!reader.IsValid()) {
+            std::cerr << argv[i] << ": not a replay log\n";
+            return 1;
+        }
+        ReplaySession session;
+        while (reader.Next(session)) {
+            ++sessions;
+            if (!ValidateReplay(session)) {
+                ++mismatches;
+                std::cout << argv[i] << ": session " << sessions << " (seed " << session.initial_state.seed_
+                          << ") does not replay to its logged outcome\n";
+            }
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << sessions << " sessions replayed, " << mismatches << " mismatches, "
+              << static_cast<double>(sessions) / elapsed.count() << " sessions/s\n";
+    return mismatches == 0 ? 0 : 2;
+}
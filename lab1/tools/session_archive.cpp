@@ -0,0 +1,254 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/replay/replay_log.h"
+#include "../src/replay/session_archive.h"
+#include "../src/simulation/policy_search.h"
+#include "../src/simulation/work_stealing_pool.h"
+#include "../src/utils/parse_number.h"
+
+namespace {
+
+// Trades on the price, so decisions change from year to year like a player's.
+constexpr Strategy kBenchStrategy{1.0, 0.6, 20.0, 0.3, 24.0, 0.1};
+constexpr int kRandomReads = 10000;
+// Every fourth game is archived from a save loaded in year 3, so the archive has to carry the deaths
+// and births a resumed game brings along.
+constexpr std::uint64_t kResumeEvery = 4;
+constexpr int kResumeYear = 3;
+
+// Length of the session as text: a line with the seed and the starting city, then a line for every
+// year with the decision, the draws and the city, numbers separated by spaces like a text save.
+std::size_t TextSize(const ArchivedSession& session) {
+    char line[256];
+    const GameState& initial = session.initial_state;
+    std::size_t size = std::snprintf(line, sizeof(line), "%llu %d %d %d %d %d\n",
+                                     static_cast<unsigned long long>(initial.seed_), initial.year_,
+                                     initial.population_, initial.acres_, initial.wheat_, session.initial_land_price);
+    for (const ArchivedYear& year : session.years) {
+        const UserInputData& decision = year.decision;
+        const YearEvents& events = year.events;
+        size += std::snprintf(line, sizeof(line), "%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d\n",
+                              decision.acres_to_buy, decision.acres_to_sell, decision.wheat_to_plant,
+                              decision.wheat_to_eat, events.year, events.harvest, events.wheat_per_acre,
+                              events.rats_ate, events.plague ? 1 : 0, events.starvation_deaths, events.new_citizens,
+                              events.land_price, year.state.population_, year.state.acres_, year.state.wheat_);
+    }
+    return size;
+}
+
+bool SameState(const GameState& a, const GameState& b) {
+    return a.seed_ == b.seed_ && a.year_ == b.year_ && a.population_ == b.population_ && a.acres_ == b.acres_ &&
+           a.wheat_ == b.wheat_;
+}
+
+bool SameYear(const ArchivedYear& a, const ArchivedYear& b) {
+    return a.decision.acres_to_buy == b.decision.acres_to_buy && a.decision.acres_to_sell == b.decision.acres_to_sell &&
+           a.decision.wheat_to_plant == b.decision.wheat_to_plant &&
+           a.decision.wheat_to_eat == b.decision.wheat_to_eat && a.events.year == b.events.year &&
+           a.events.harvest == b.events.harvest && a.events.wheat_per_acre == b.events.wheat_per_acre &&
+           a.events.rats_ate == b.events.rats_ate && a.events.plague == b.events.plague &&
+           a.events.starvation_deaths == b.events.starvation_deaths &&
+           a.events.new_citizens == b.events.new_citizens && a.events.land_price == b.events.land_price &&
+           SameState(a.state, b.state);
+}
+
+bool SameSession(const ArchivedSession& a, const ArchivedSession& b) {
+    return SameState(a.initial_state, b.initial_state) && a.initial_land_price == b.initial_land_price &&
+           a.initial_starvation_deaths == b.initial_starvation_deaths &&
+           a.initial_new_citizens == b.initial_new_citizens &&
+           a.initial_total_starvation_deaths == b.initial_total_starvation_deaths &&
+           std::equal(a.years.begin(), a.years.end(), b.years.begin(), b.years.end(), SameYear);
+}
+
+// Whether replaying an archived session ends where the game it came from did.
+bool SameEnd(const GameEngine& a, const GameEngine& b) {
+    return SameState(a.game_state(), b.game_state()) && a.total_starvation_deaths() == b.total_starvation_deaths() &&
+           a.CalculateResults() == b.CalculateResults();
+}
+
+// Plays a game of the bench strategy; `end`, if given, receives the engine as the game ended.
+ArchivedSession PlaySession(const std::uint64_t seed, GameEngine* end = nullptr) {
+    GameEngine engine{GameState(seed)};
+    engine.GenerateRandomParams();
+    if (seed % kResumeEvery == 0) {
+        while (!engine.IsGameOver() && engine.game_state().year_ < kResumeYear) {
+            engine.PlayYear(kBenchStrategy.Decide(engine));
+        }
+        engine = GameEngine(engine.Snapshot());
+    }
+    ArchivedSession session;
+    session.Begin(engine);
+    while (!engine.IsGameOver()) {
+        const UserInputData decision = kBenchStrategy.Decide(engine);
+        session.AddYear(decision, engine.PlayYear(decision), engine);
+    }
+    if (end != nullptr) {
+        *end = engine;
+    }
+    return session;
+}
+
+int Pack(const char* log_path, const char* archive_path) {
+    ReplayLogReader log(log_path);
+    SessionArchiveWriter archive;
+    if (!log.IsValid() || !archive.Open(archive_path)) {
+        std::cerr << "Cannot open " << (log.IsValid() ? archive_path : log_path) << '\n';
+        return 1;
+    }
+    ReplaySession session;
+    ArchivedSession archived;
+    std::uint64_t mismatched = 0;
+    while (log.Next(session)) {
+        mismatched += ArchiveReplay(session, archived) ? 0 : 1;
+        archive.Add(archived);
+    }
+    if (!archive.Close()) {
+        std::cerr << "Cannot write " << archive_path << '\n';
+        return 1;
+    }
+    std::cout << "archived " << archive.size() << " sessions, " << mismatched << " did not replay as logged\n";
+    return 0;
+}
+
+int Bench(const char* archive_path, const std::uint64_t games, const std::uint64_t seed, const unsigned threads) {
+    SessionArchiveWriter writer;
+    if (!writer.Open(archive_path)) {
+        std::cerr << "Cannot write " << archive_path << '\n';
+        return 1;
+    }
+    std::size_t text_bytes = 0;
+    std::size_t years = 0;
+    for (std::uint64_t game = 0; game < games; ++game) {
+        const ArchivedSession session = PlaySession(seed + game);
+        text_bytes += TextSize(session);
+        years += session.years.size();
+        writer.Add(session);
+    }
+    writer.Close();
+
+    SessionArchiveReader reader;
+    if (!reader.Open(archive_path)) {
+        std::cerr << "Cannot read " << archive_path << '\n';
+        return 1;
+    }
+    std::cout << "sessions: " << reader.size() << ", years: " << years << '\n'
+              << "text: " << text_bytes << " bytes, archive: " << reader.byte_size() << " bytes ("
+              << static_cast<double>(text_bytes) / static_cast<double>(reader.byte_size()) << "x smaller, "
+              << 8.0 * static_cast<double>(reader.byte_size()) / static_cast<double>(years) << " bits per year)\n";
+
+    ArchivedSession session;
+    std::size_t decoded_bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (reader.Next(session)) {
+        decoded_bytes += sizeof(ArchivedSession) + session.years.size() * sizeof(ArchivedYear);
+    }
+    const std::chrono::duration<double> sequential = std::chrono::steady_clock::now() - start;
+    std::cout << "sequential decode: " << static_cast<double>(reader.size()) / sequential.count() / 1e6
+              << " M sessions/s, " << static_cast<double>(decoded_bytes) / sequential.count() / 1e9
+              << " GB/s of decoded sessions\n";
+
+    // The same again with every thread taking blocks of its own.
+    const WorkStealingPool pool(threads);
+    std::vector<std::vector<ArchivedSession>> blocks(pool.threads());
+    std::vector<std::size_t> decoded(pool.threads(), 0);
+    start = std::chrono::steady_clock::now();
+    pool.Run(static_cast<std::uint32_t>(reader.block_count()), [&](const unsigned worker, const std::uint32_t block) {
+        reader.DecodeBlock(block, blocks[worker]);
+        for (const ArchivedSession& decoded_session : blocks[worker]) {
+            decoded[worker] += sizeof(ArchivedSession) + decoded_session.years.size() * sizeof(ArchivedYear);
+        }
+    });
+    const std::chrono::duration<double> parallel = std::chrono::steady_clock::now() - start;
+    std::cout << "block decode on " << pool.threads() << " threads: "
+              << static_cast<double>(std::accumulate(decoded.begin(), decoded.end(), std::size_t{0})) /
+                     parallel.count() / 1e9
+              << " GB/s of decoded sessions\n";
+
+    std::uint64_t mismatched = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRandomReads; ++i) {
+        const std::uint64_t index = (static_cast<std::uint64_t>(i) * 2654435761u) % reader.size();
+        if (!reader.Read(index, session)) {
+            std::cerr << "Cannot read session " << index << '\n';
+            return 1;
+        }
+        GameEngine played;
+        const ArchivedSession expected = PlaySession(seed + index, &played);
+        mismatched += SameSession(session, expected) && SameEnd(ReplayArchived(session), played) ? 0 : 1;
+    }
+    const std::chrono::duration<double, std::micro> random = std::chrono::steady_clock::now() - start;
+    std::cout << "random reads: " << random.count() / kRandomReads
+              << " us per session (with two replays to compare, one in four resumed), " << mismatched
+              << " mismatched\n";
+    return mismatched == 0 ? 0 : 1;
+}
+
+int Show(const char* archive_path, const std::uint64_t index) {
+    SessionArchiveReader reader;
+    ArchivedSession session;
+    if (!reader.Open(archive_path) || !reader.Read(index, session)) {
+        std::cerr << "Cannot read session " << index << " of " << archive_path << '\n';
+        return 1;
+    }
+    const GameState& initial = session.initial_state;
+    std::cout << "seed " << initial.seed_ << ", year " << initial.year_ << ": population " << initial.population_
+              << ", acres " << initial.acres_ << ", wheat " << initial.wheat_ << ", land price "
+              << session.initial_land_price << '\n';
+    if (session.initial_total_starvation_deaths != 0 || session.initial_starvation_deaths != 0 ||
+        session.initial_new_citizens != 0) {
+        std::cout << "resumed: " << session.initial_starvation_deaths << " starved and " << session.initial_new_citizens
+                  << " born the year before, " << session.initial_total_starvation_deaths << " starved in all\n";
+    }
+    std::cout << "year\tbuy\tsell\tplant\teat\tyield\trats\tplague\tdeaths\tborn\tprice\tpopulation\tacres\twheat\n";
+    for (const ArchivedYear& year : session.years) {
+        std::cout << year.events.year << '\t' << year.decision.acres_to_buy << '\t' << year.decision.acres_to_sell
+                  << '\t' << year.decision.wheat_to_plant << '\t' << year.decision.wheat_to_eat << '\t'
+                  << year.events.wheat_per_acre << '\t' << year.events.rats_ate << '\t' << year.events.plague << '\t'
+                  << year.events.starvation_deaths << '\t' << year.events.new_citizens << '\t'
+                  << year.events.land_price << '\t' << year.state.population_ << '\t' << year.state.acres_ << '\t'
+                  << year.state.wheat_ << '\n';
+    }
+    return 0;
+}
+
+}  // namespace
+
+// Usage:
+//   session_archive pack <replay_log> <archive>
+//   session_archive bench <archive> [games] [seed] [threads]
+//   session_archive show <archive> <index>
+// `pack` archives every session of a replay log, `bench` archives games of a trading strategy and
+// reports the size against text and the decode speed, `show` prints one session.
+int main(const int argc, char* argv[]) {
+    if (argc >= 4 && std::strcmp(argv[1], "pack") == 0) {
+        return Pack(argv[2], argv[3]);
+    }
+    if (argc >= 3 && std::strcmp(argv[1], "bench") == 0) {
+        std::uint64_t games = 1000000;
+        std::uint64_t seed = 0;
+        int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        if ((argc <= 3 || ParseNumber(argv[3], 1, games)) && (argc <= 4 || ParseNumber(argv[4], 0, seed)) &&
+            (argc <= 5 || ParseNumber(argv[5], 1, threads))) {
+            return Bench(argv[2], games, seed, static_cast<unsigned>(threads));
+        }
+    }
+    std::uint64_t index = 0;
+    if (argc >= 4 && std::strcmp(argv[1], "show") == 0 && ParseNumber(argv[3], 0, index)) {
+        return Show(argv[2], index);
+    }
+    std::cerr << "Usage: " << argv[0] << " pack <replay_log> <archive>\n"
+              << "       " << argv[0] << " bench <archive> [games] [seed] [threads]\n"
+              << "       " << argv[0] << " show <archive> <index>\n"
+              << "The seed and the index are whole numbers of at least 0, the games and the threads at least 1.\n";
+    return 1;
+}
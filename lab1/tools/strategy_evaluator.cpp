@@ -0,0 +1,69 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "../src/simulation/monte_carlo.h"
+#include "../src/utils/parse_number.h"
+
+namespace {
+
+const char* const kResultNames[kGameResultCount] = {
+    "ruined", "starvation", "exiled", "iron fist", "average", "fantastic",
+};
+
+template<std::size_t Bins>
+void PrintHistogram(const char* title, const Histogram<Bins>& histogram, const int bin_width,
+                    const std::uint64_t games) {
+    std::cout << title << ":\n";
+    for (std::size_t i = 0; i < Bins; ++i) {
+        if (histogram.counts[i] == 0) {
+            continue;
+        }
+        std::cout << "  " << i * bin_width << (i + 1 == Bins ? "+" : "") << '\t' << histogram.counts[i] << '\t'
+                  << 100.0 * static_cast<double>(histogram.counts[i]) / static_cast<double>(games) << "%\n";
+    }
+}
+
+}  // namespace
+
+int main(const int argc, char* argv[]) {
+    UserInputData policy;
+    std::uint64_t games = 1000000;
+    std::uint64_t seed = 0;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    if (argc < 5 || !ParseNumber(argv[1], 0, policy.acres_to_buy) || !ParseNumber(argv[2], 0, policy.acres_to_sell) ||
+        !ParseNumber(argv[3], 0, policy.wheat_to_plant) || !ParseNumber(argv[4], 0, policy.wheat_to_eat) ||
+        (argc > 5 && !ParseNumber(argv[5], 1, games)) || (argc > 6 && !ParseNumber(argv[6], 0, seed)) ||
+        (argc > 7 && !ParseNumber(argv[7], 1, threads))) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <acres_to_buy> <acres_to_sell> <wheat_to_plant> <wheat_to_eat> [games] [seed] [threads]"
+                     " [rules_file]\n"
+                  << "The amounts and the seed are whole numbers of at least 0,"
+                     " the games and the threads at least 1.\n";
+        return 1;
+    }
+    Ruleset rules;
+    if (argc > 8 && !LoadRuleset(argv[8], rules)) {
+        std::cerr << "Invalid rules file " << argv[8] << '\n';
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const MonteCarloResult result =
+        EvaluatePolicy(policy, games, seed, static_cast<unsigned>(threads), argc > 8 ? &rules : nullptr);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << result.games << " games in " << elapsed.count() << " s ("
+              << static_cast<double>(result.games) / elapsed.count() << " games/s)\n";
+    std::cout << "Results:\n";
+    for (int i = 0; i < kGameResultCount; ++i) {
+        std::cout << "  " << kResultNames[i] << '\t' << result.results.counts[i] << '\t'
+                  << 100.0 * static_cast<double>(result.results.counts[i]) / static_cast<double>(result.games)
+                  << "%\n";
+    }
+    PrintHistogram("Population", result.population, 10, result.games);
+    PrintHistogram("Acres per person", result.acres_per_person, 1, result.games);
+}
@@ -0,0 +1,78 @@
+// Copyright 2024 Sergo Elizbarashvili
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "../src/game/game_engine.h"
+#include "../src/replay/year_trace.h"
+#include "../src/utils/parse_number.h"
+#include "../src/utils/random.h"
+
+namespace {
+
+// Rows per write: about 30 MB of binary trace.
+constexpr std::size_t kBatchRows = std::size_t{1} << 20;
+
+}  // namespace
+
+// Plays games with a fixed policy and writes every year of every game to a trace file. Game i
+// uses the same seed as in strategy_evaluator, so traces line up with its statistics.
+int main(const int argc, char* argv[]) {
+    UserInputData policy;
+    std::uint64_t games = 1000000;
+    std::uint64_t seed = 0;
+    if (argc < 6 || !ParseNumber(argv[1], 0, policy.acres_to_buy) || !ParseNumber(argv[2], 0, policy.acres_to_sell) ||
+        !ParseNumber(argv[3], 0, policy.wheat_to_plant) || !ParseNumber(argv[4], 0, policy.wheat_to_eat) ||
+        (argc > 6 && !ParseNumber(argv[6], 1, games)) || (argc > 7 && !ParseNumber(argv[7], 0, seed)) ||
+        (argc > 8 && std::strcmp(argv[8], "binary") != 0 && std::strcmp(argv[8], "csv") != 0)) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <acres_to_buy> <acres_to_sell> <wheat_to_plant> <wheat_to_eat> <output> [games] [seed]"
+                     " [binary|csv]\n"
+                  << "The amounts and the seed are whole numbers of at least 0, the games at least 1.\n";
+        return 1;
+    }
+    const bool csv = argc > 8 && std::strcmp(argv[8], "csv") == 0;
+
+    std::FILE* file = std::fopen(argv[5], "wb");
+    if (file == nullptr) {
+        std::cerr << "Cannot open " << argv[5] << '\n';
+        return 1;
+    }
+    // Every batch goes out in a single write; stdio buffering would only add a copy.
+    std::setvbuf(file, nullptr, _IONBF, 0);
+
+    YearTrace trace;
+    trace.Reserve(kBatchRows + 64);
+    std::uint64_t rows = 0;
+    bool written = true;
+    const auto flush = [&] {
+        rows += trace.size();
+        written = (csv ? trace.WriteCsv(file, rows == trace.size()) : trace.WriteBinary(file)) && written;
+        trace.Clear();
+    };
+    const auto start = std::chrono::steady_clock::now();
+    for (std::uint64_t game = 0; game < games; ++game) {
+        GameEngine engine{GameState(seed ^ SplitMix64(game))};
+        engine.SetTrace(&trace);
+        engine.PlayReign([&](const GameEngine& current) { return current.ClampDecision(policy); });
+        if (trace.size() >= kBatchRows) {
+            flush();
+        }
+    }
+    if (trace.size() > 0 || rows == 0) {
+        flush();
+    }
+    written = std::fclose(file) == 0 && written;
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (!written) {
+        std::cerr << "Failed to write " << argv[5] << '\n';
+        return 1;
+    }
+    std::cout << games << " games, " << rows << " years in " << elapsed.count() << " s ("
+              << static_cast<double>(rows) / elapsed.count() << " years/s)\n";
+    return 0;
+}
@@ -1,26 +1,71 @@
 #pragma once
 
 #include <iostream>
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
 #include <utility>
 #include <vector>
 
+#include "growth_policy.h"
+#include "malloc_allocator.h"
+#include "trivially_relocatable.h"
+
+// Room for Capacity elements inside the array itself; nothing at all when Capacity is 0.
+template<typename T, int Capacity>
+struct ArrayInlineStorage {
+    alignas(T) unsigned char bytes[Capacity * sizeof(T)];
+
+    T* data() { return reinterpret_cast<T*>(bytes); }
+    const T* data() const { return reinterpret_cast<const T*>(bytes); }
+};
+
 template<typename T>
+struct ArrayInlineStorage<T, 0> {
+    T* data() { return nullptr; }
+    const T* data() const { return nullptr; }
+};
+
+// GrowthPolicy picks the capacity the array grows to once it is full; see growth_policy.h.
+// Memory comes from Allocator through std::allocator_traits, so any standard allocator works,
+// std::pmr::polymorphic_allocator included (see pmr::Array below).
+// The first InlineCapacity elements live inside the array, so that small arrays never allocate;
+// see SmallArray in small_array.h.
+template<typename T, typename GrowthPolicy = GeometricGrowth<2>, typename Allocator = MallocAllocator<T>,
+         int InlineCapacity = 0>
 class Array final {
+    using AllocatorTraits = std::allocator_traits<Allocator>;
+    static_assert(std::is_same_v<typename AllocatorTraits::value_type, T>, "Allocator must allocate T");
+
+    // Whether a moved-to array can always take over the other's block.
+    static constexpr bool kMoveSteals = AllocatorTraits::propagate_on_container_move_assignment::value ||
+                                        AllocatorTraits::is_always_equal::value;
+    // Inline elements cannot be taken over, only moved one by one.
+    static constexpr bool kMoveNothrow = InlineCapacity == 0 || std::is_nothrow_move_constructible_v<T>;
+    static constexpr int kDefaultCapacity = InlineCapacity > 0 ? InlineCapacity : 8;
+
 public:
-    static constexpr float kResizeFactor = 2;
+    using allocator_type = Allocator;
 
-    explicit Array(int capacity = 8);
+    explicit Array(int capacity = kDefaultCapacity, const Allocator& allocator = Allocator());
+
+    explicit Array(const Allocator& allocator);
 
     ~Array();
 
     Array(const Array& other);
 
-    Array(Array&& other) noexcept;
+    Array(const Array& other, const Allocator& allocator);
+
+    Array(Array&& other) noexcept(kMoveNothrow);
 
     Array& operator=(const Array& other);
 
-    Array& operator=(Array&& other) noexcept;
+    // Takes over the other array's block unless its elements are inline or the allocators differ
+    // and do not propagate, in which case the elements are moved one by one.
+    Array& operator=(Array&& other) noexcept(kMoveSteals && kMoveNothrow);
 
     int insert(const T& value);
 
@@ -33,6 +78,12 @@ public:
 
     [[nodiscard]] int size() const;
     [[nodiscard]] int capacity() const;
+    [[nodiscard]] Allocator get_allocator() const;
+
+    // Makes room for at least `capacity` elements without growing again.
+    void reserve(int capacity);
+    // Releases the capacity beyond size().
+    void shrink_to_fit();
 
     class Iterator;
     class ConstIterator;
@@ -49,10 +100,22 @@ public:
     T* data_;
     int size_;
     int capacity_;
+    [[no_unique_address]] Allocator allocator_;
+    [[no_unique_address]] ArrayInlineStorage<T, InlineCapacity> inline_;
 
     void resize();
+    void reallocate(int new_capacity);
+    // Storage for `capacity` elements: inline if they fit, a new block otherwise.
+    void acquire(int capacity);
+    // Back to the inline storage, or to no block at all, without touching the elements.
+    void setEmpty();
+    [[nodiscard]] bool isInline() const;
+    // No block for no elements.
+    T* allocate(int capacity);
+    void deallocate();
+    // Moves `count` elements to uninitialised storage at `to`, leaving none at `from`.
+    void relocate(T* from, T* to, int count);
     void clear();
-    void swap_(Array& other);
 
 public:
     class Iterator {
@@ -158,144 +221,285 @@ public:
     };
 };
 
+namespace pmr {
 
-template<typename T>
-Array<T>::Array(const int capacity) : size_(0), capacity_(capacity) {
-    data_ = static_cast<T*>(malloc(capacity_ * sizeof(T)));
+// An Array whose memory comes from a std::pmr::memory_resource, e.g. a request's
+// monotonic_buffer_resource: pmr::Array<int> a(8, &arena);
+template<typename T, typename GrowthPolicy = GeometricGrowth<2>>
+using Array = ::Array<T, GrowthPolicy, std::pmr::polymorphic_allocator<T>>;
+
+}  // namespace pmr
+
+
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+Array<T, GrowthPolicy, Allocator, InlineCapacity>::Array(const int capacity, const Allocator& allocator)
+    : data_(nullptr), size_(0), capacity_(0), allocator_(allocator) {
+    acquire(capacity);
 }
 
-template<typename T>
-Array<T>::~Array() {
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+Array<T, GrowthPolicy, Allocator, InlineCapacity>::Array(const Allocator& allocator) : Array(kDefaultCapacity, allocator) {}
+
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+Array<T, GrowthPolicy, Allocator, InlineCapacity>::~Array() {
     clear();
-    free(data_);
+    deallocate();
 }
 
 // copy constructor
-template<typename T>
-Array<T>::Array(const Array& other) : size_(other.size_), capacity_(other.capacity_) {
-    data_ = static_cast<T*>(malloc(capacity_ * sizeof(T)));
-    for(int i = 0; i < size_; i++) {
-        new (&data_[i]) T(other.data_[i]);
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+Array<T, GrowthPolicy, Allocator, InlineCapacity>::Array(const Array& other)
+    : Array(other, AllocatorTraits::select_on_container_copy_construction(other.allocator_)) {}
+
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+Array<T, GrowthPolicy, Allocator, InlineCapacity>::Array(const Array& other, const Allocator& allocator)
+    : data_(nullptr), size_(0), capacity_(0), allocator_(allocator) {
+    acquire(other.capacity_);
+    for(int i = 0; i < other.size_; i++) {
+        AllocatorTraits::construct(allocator_, data_ + i, other.data_[i]);
+        ++size_;
     }
 }
 
 
 // move constructor
-template<typename T>
-Array<T>::Array(Array&& other) noexcept : data_(other.data_), size_(other.size_), capacity_(other.capacity_) {
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+Array<T, GrowthPolicy, Allocator, InlineCapacity>::Array(Array&& other) noexcept(kMoveNothrow)
+    : data_(other.data_), size_(other.size_), capacity_(other.capacity_), allocator_(std::move(other.allocator_)) {
+    if (other.isInline()) {
+        setEmpty();
+        relocate(other.data_, data_, size_);
+    } else {
+        other.setEmpty();
+    }
     other.size_ = 0;
-    other.capacity_ = 0;
-    other.data_ = nullptr;
 }
 
-template<typename T>
-Array<T>& Array<T>::operator=(const Array& other) {
-    Array tmp(other);
-    swap_(tmp);
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+Array<T, GrowthPolicy, Allocator, InlineCapacity>& Array<T, GrowthPolicy, Allocator, InlineCapacity>::operator=(const Array& other) {
+    if (this == &other) {
+        return *this;
+    }
+    if constexpr (AllocatorTraits::propagate_on_container_copy_assignment::value) {
+        if (allocator_ != other.allocator_) {
+            clear();
+            size_ = 0;
+            deallocate();
+            setEmpty();
+        }
+        allocator_ = other.allocator_;
+    }
+    *this = Array(other, allocator_);
     return *this;
 }
 
 // move assignment
-template<typename T>
-Array<T>& Array<T>::operator=(Array&& other) noexcept {
-    swap_(other);
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+Array<T, GrowthPolicy, Allocator, InlineCapacity>& Array<T, GrowthPolicy, Allocator, InlineCapacity>::operator=(Array&& other) noexcept(kMoveSteals && kMoveNothrow) {
+    if (this == &other) {
+        return *this;
+    }
+    clear();
+    size_ = 0;
+    if constexpr (AllocatorTraits::propagate_on_container_move_assignment::value) {
+        if (allocator_ != other.allocator_) {
+            deallocate();
+            setEmpty();
+        }
+        allocator_ = other.allocator_;
+    }
+    if (other.isInline() || allocator_ != other.allocator_) {
+        reserve(other.size_);
+        relocate(other.data_, data_, other.size_);
+        size_ = std::exchange(other.size_, 0);
+        return *this;
+    }
+    deallocate();
+    data_ = other.data_;
+    size_ = std::exchange(other.size_, 0);
+    capacity_ = other.capacity_;
+    other.setEmpty();
     return *this;
 }
 
-template<typename T>
-int Array<T>::insert(const T& value) {
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+int Array<T, GrowthPolicy, Allocator, InlineCapacity>::insert(const T& value) {
     return insert(size_, value);
 }
 
-template<typename T>
-int Array<T>::insert(int index, const T& value) {
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+int Array<T, GrowthPolicy, Allocator, InlineCapacity>::insert(int index, const T& value) {
     assert(index >= 0 && index <= size_);
     if (size_ >= capacity_) {
         resize();
     }
-    for (int i = size_; i > index; --i) {
-        new (&data_[i]) T(std::move(data_[i - 1]));
-        data_[i - 1].~T();
+    if constexpr (kIsTriviallyRelocatable<T>) {
+        // Appending has nothing to shift; skip the call.
+        if (index < size_) {
+            std::memmove(static_cast<void*>(data_ + index + 1), data_ + index, (size_ - index) * sizeof(T));
+        }
+    } else {
+        for (int i = size_; i > index; --i) {
+            AllocatorTraits::construct(allocator_, data_ + i, std::move(data_[i - 1]));
+            AllocatorTraits::destroy(allocator_, data_ + i - 1);
+        }
     }
-    new (&data_[index]) T(value);
+    AllocatorTraits::construct(allocator_, data_ + index, value);
     ++size_;
     return index;
 }
 
-template<typename T>
-void Array<T>::remove(int index) {
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+void Array<T, GrowthPolicy, Allocator, InlineCapacity>::remove(int index) {
     assert(index >= 0 && index < size_);
-    data_[index].~T();
-    for (int i = index; i < size_ - 1; ++i) {
-        new (&data_[i]) T(std::move(data_[i + 1]));
-        data_[i + 1].~T();
+    AllocatorTraits::destroy(allocator_, data_ + index);
+    if constexpr (kIsTriviallyRelocatable<T>) {
+        std::memmove(static_cast<void*>(data_ + index), data_ + index + 1, (size_ - index - 1) * sizeof(T));
+    } else {
+        for (int i = index; i < size_ - 1; ++i) {
+            AllocatorTraits::construct(allocator_, data_ + i, std::move(data_[i + 1]));
+            AllocatorTraits::destroy(allocator_, data_ + i + 1);
+        }
     }
     --size_;
 }
 
-template<typename T>
-const T& Array<T>::operator[](int index) const {
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+const T& Array<T, GrowthPolicy, Allocator, InlineCapacity>::operator[](int index) const {
     return data_[index];
 }
 
-template<typename T>
-T& Array<T>::operator[](int index) {
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+T& Array<T, GrowthPolicy, Allocator, InlineCapacity>::operator[](int index) {
     return data_[index];
 }
 
-template<typename T>
-int Array<T>::size() const {
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+int Array<T, GrowthPolicy, Allocator, InlineCapacity>::size() const {
     return size_;
 }
 
-template<typename T>
-int Array<T>::capacity() const {
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+int Array<T, GrowthPolicy, Allocator, InlineCapacity>::capacity() const {
     return capacity_;
 }
 
-template<typename T>
-typename Array<T>::Iterator Array<T>::iterator() {
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+Allocator Array<T, GrowthPolicy, Allocator, InlineCapacity>::get_allocator() const {
+    return allocator_;
+}
+
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+typename Array<T, GrowthPolicy, Allocator, InlineCapacity>::Iterator Array<T, GrowthPolicy, Allocator, InlineCapacity>::iterator() {
     return Iterator(this, data_, size_);
 }
 
-template<typename T>
-typename Array<T>::ConstIterator Array<T>::constIterator() const {
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+typename Array<T, GrowthPolicy, Allocator, InlineCapacity>::ConstIterator Array<T, GrowthPolicy, Allocator, InlineCapacity>::constIterator() const {
     return ConstIterator(data_, size_);
 }
 
-template<typename T>
-typename Array<T>::ReverseIterator Array<T>::reverseIterator() {
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+typename Array<T, GrowthPolicy, Allocator, InlineCapacity>::ReverseIterator Array<T, GrowthPolicy, Allocator, InlineCapacity>::reverseIterator() {
     return ReverseIterator(data_, size_);
 }
 
-template<typename  T>
-typename Array<T>::ConstReverseIterator Array<T>::constReverseIterator() const {
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+typename Array<T, GrowthPolicy, Allocator, InlineCapacity>::ConstReverseIterator Array<T, GrowthPolicy, Allocator, InlineCapacity>::constReverseIterator() const {
     return ConstReverseIterator(data_, size_);
 }
 
 
-template<typename T>
-void Array<T>::resize() {
-    const int new_capacity = static_cast<int>(capacity_ * kResizeFactor);
-    T* new_data = static_cast<T*>(malloc(new_capacity * sizeof(T)));
-    for(size_t i = 0; i < size_; i++) {
-        new (&new_data[i]) T(std::move(data_[i]));
-        data_[i].~T();
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+void Array<T, GrowthPolicy, Allocator, InlineCapacity>::reserve(const int capacity) {
+    if (capacity > capacity_) {
+        reallocate(capacity);
     }
-    free(data_);
+}
+
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+void Array<T, GrowthPolicy, Allocator, InlineCapacity>::shrink_to_fit() {
+    if (size_ < capacity_) {
+        reallocate(size_);
+    }
+}
+
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+void Array<T, GrowthPolicy, Allocator, InlineCapacity>::resize() {
+    reallocate(GrowthPolicy::grow(capacity_, size_ + 1, sizeof(T)));
+}
+
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+void Array<T, GrowthPolicy, Allocator, InlineCapacity>::reallocate(const int new_capacity) {
+    const bool to_inline = new_capacity <= InlineCapacity;
+    if (to_inline && isInline()) {
+        return;
+    }
+    if constexpr (kIsTriviallyRelocatable<T> && Reallocating<Allocator>) {
+        // realloc often grows the block in place.
+        if (!to_inline && data_ != nullptr && !isInline()) {
+            data_ = allocator_.reallocate(data_, capacity_, new_capacity);
+            capacity_ = new_capacity;
+            return;
+        }
+    }
+    T* new_data = to_inline ? inline_.data() : allocate(new_capacity);
+    relocate(data_, new_data, size_);
+    deallocate();
     data_ = new_data;
-    capacity_ = new_capacity;
+    capacity_ = to_inline ? InlineCapacity : new_capacity;
 }
 
-template<typename T>
-void Array<T>::clear() {
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+void Array<T, GrowthPolicy, Allocator, InlineCapacity>::acquire(const int capacity) {
+    if (capacity <= InlineCapacity) {
+        setEmpty();
+    } else {
+        data_ = allocate(capacity);
+        capacity_ = capacity;
+    }
+}
+
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+void Array<T, GrowthPolicy, Allocator, InlineCapacity>::setEmpty() {
+    data_ = inline_.data();
+    capacity_ = InlineCapacity;
+}
+
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+bool Array<T, GrowthPolicy, Allocator, InlineCapacity>::isInline() const {
+    return InlineCapacity > 0 && data_ == inline_.data();
+}
+
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+T* Array<T, GrowthPolicy, Allocator, InlineCapacity>::allocate(const int capacity) {
+    return capacity > 0 ? AllocatorTraits::allocate(allocator_, capacity) : nullptr;
+}
+
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+void Array<T, GrowthPolicy, Allocator, InlineCapacity>::deallocate() {
+    if (data_ != nullptr && !isInline()) {
+        AllocatorTraits::deallocate(allocator_, data_, capacity_);
+    }
+}
+
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+void Array<T, GrowthPolicy, Allocator, InlineCapacity>::relocate(T* from, T* to, const int count) {
+    if constexpr (kIsTriviallyRelocatable<T>) {
+        if (count > 0) {
+            std::memcpy(static_cast<void*>(to), from, count * sizeof(T));
+        }
+    } else {
+        for(int i = 0; i < count; i++) {
+            AllocatorTraits::construct(allocator_, to + i, std::move(from[i]));
+            AllocatorTraits::destroy(allocator_, from + i);
+        }
+    }
+}
+
+template<typename T, typename GrowthPolicy, typename Allocator, int InlineCapacity>
+void Array<T, GrowthPolicy, Allocator, InlineCapacity>::clear() {
     for (int i = 0; i < size_; ++i) {
-        data_[i].~T();
+        AllocatorTraits::destroy(allocator_, data_ + i);
     }
 }
-template<typename T>
-void Array<T>::swap_(Array& other) {
-    std::swap(size_, other.size_);
-    std::swap(capacity_, other.capacity_);
-    std::swap(data_, other.data_);
-}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+
+// Growth policies for Array. grow() returns the capacity to reallocate to when `required`
+// elements of `element_size` bytes no longer fit in `capacity`; it is never less than `required`.
+
+// Multiplies the capacity by Numerator / Denominator: GeometricGrowth<3, 2> grows by 1.5.
+template<int Numerator, int Denominator = 1>
+struct GeometricGrowth {
+    static_assert(Numerator > Denominator && Denominator > 0, "growth factor must be above 1");
+
+    static int grow(const int capacity, const int required, std::size_t /*element_size*/) {
+        const long long grown = static_cast<long long>(capacity) * Numerator / Denominator;
+        return static_cast<int>(std::max<long long>(grown, required));
+    }
+};
+
+// Grows by 1.5 and then up to the end of the jemalloc size class the block lands in, so the
+// bytes the allocator would round up to anyway hold elements instead of going to waste.
+struct SizeClassGrowth {
+    // jemalloc size classes: 8, then steps of 16 up to 128, then four classes per doubling
+    // (160, 192, 224, 256, 320, ...).
+    static std::size_t sizeClass(const std::size_t bytes) {
+        if (bytes <= 8) {
+            return 8;
+        }
+        if (bytes <= 128) {
+            return (bytes + 15) & ~std::size_t{15};
+        }
+        const std::size_t spacing = std::size_t{1} << (std::bit_width(bytes - 1) - 3);
+        return (bytes + spacing - 1) & ~(spacing - 1);
+    }
+
+    static int grow(const int capacity, const int required, const std::size_t element_size) {
+        const int grown = GeometricGrowth<3, 2>::grow(capacity, required, element_size);
+        return static_cast<int>(sizeClass(static_cast<std::size_t>(grown) * element_size) / element_size);
+    }
+};
+
+// Adds Elements at a time: memory stays within a chunk of the size, but every append past the
+// capacity moves the whole array, so appends cost O(n) each.
+template<int Elements>
+struct ChunkGrowth {
+    static_assert(Elements > 0, "chunk must hold at least one element");
+
+    static int grow(const int capacity, const int required, std::size_t /*element_size*/) {
+        const int grown = capacity + Elements;
+        return std::max(grown, (required + Elements - 1) / Elements * Elements);
+    }
+};
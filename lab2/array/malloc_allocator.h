@@ -0,0 +1,51 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// Array's default allocator: malloc() and free(), plus realloc() for elements that can be moved
+// bytewise (see trivially_relocatable.h).
+template<typename T>
+struct MallocAllocator {
+    using value_type = T;
+
+    MallocAllocator() = default;
+
+    template<typename U>
+    MallocAllocator(const MallocAllocator<U>&) noexcept {}
+
+    T* allocate(const std::size_t n) {
+        return checked(malloc(std::max<std::size_t>(n * sizeof(T), 1)));
+    }
+
+    void deallocate(T* p, std::size_t /*n*/) noexcept {
+        free(p);
+    }
+
+    // Not in the Allocator requirements: moves the n elements at p to a block of new_n, often
+    // without copying them.
+    T* reallocate(T* p, std::size_t /*n*/, const std::size_t new_n) {
+        return checked(realloc(static_cast<void*>(p), std::max<std::size_t>(new_n * sizeof(T), 1)));
+    }
+
+    friend bool operator==(const MallocAllocator&, const MallocAllocator&) noexcept {
+        return true;
+    }
+
+private:
+    static T* checked(void* p) {
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(p);
+    }
+};
+
+// Allocators with a reallocate() like MallocAllocator's.
+template<typename A>
+concept Reallocating = requires(A& allocator, typename A::value_type* p, std::size_t n) {
+    { allocator.reallocate(p, n, n) } -> std::same_as<typename A::value_type*>;
+};
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "array.h"
+
+// An Array that keeps up to N elements inside itself and only goes to the heap beyond that;
+// shrink_to_fit() brings it back once N elements fit again. Same API and iterators as Array.
+// Default-constructed, it has capacity N and has allocated nothing.
+template<typename T, int N, typename GrowthPolicy = GeometricGrowth<2>, typename Allocator = MallocAllocator<T>>
+using SmallArray = Array<T, GrowthPolicy, Allocator, N>;
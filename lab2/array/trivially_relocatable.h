@@ -0,0 +1,18 @@
+#pragma once
+
+#include <type_traits>
+
+// Whether a T can be moved to another address by copying its bytes, leaving nothing to destroy
+// at the old one. Array then shifts and reallocates its elements with memmove and realloc.
+// True for trivially copyable types; specialise it for types of your own that only own what
+// they point to, e.g.
+//
+//     template<>
+//     struct IsTriviallyRelocatable<Buffer> : std::true_type {};
+//
+// Not for types that point into themselves, such as std::string with its inline buffer.
+template<typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+template<typename T>
+inline constexpr bool kIsTriviallyRelocatable = IsTriviallyRelocatable<T>::value;
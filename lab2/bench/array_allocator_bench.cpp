@@ -0,0 +1,81 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+#include "array/array.h"
+
+namespace {
+
+constexpr int kArraysPerRequest = 16;
+constexpr int kElementsPerArray = 40;
+
+// A request's worth of scratch arrays, filled and dropped.
+template<typename ArrayType, typename... Args>
+long long handleRequest(const int request, Args&&... args) {
+    long long sum = 0;
+    for (int a = 0; a < kArraysPerRequest; ++a) {
+        ArrayType arr(4, args...);
+        for (int i = 0; i < kElementsPerArray; ++i) {
+            arr.insert(request + i);
+        }
+        sum += arr[kElementsPerArray / 2];
+    }
+    return sum;
+}
+
+void work(const char* resource, const int requests, long long& sum) {
+    if (std::strcmp(resource, "malloc") == 0) {
+        for (int r = 0; r < requests; ++r) {
+            sum += handleRequest<Array<long long>>(r);
+        }
+    } else if (std::strcmp(resource, "monotonic") == 0) {
+        // Everything a request allocates comes off one buffer, dropped at the end of the request.
+        alignas(std::max_align_t) static thread_local char buffer[64 * 1024];
+        for (int r = 0; r < requests; ++r) {
+            std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer));
+            sum += handleRequest<pmr::Array<long long>>(r, &arena);
+        }
+    } else {
+        std::pmr::unsynchronized_pool_resource pool;
+        for (int r = 0; r < requests; ++r) {
+            sum += handleRequest<pmr::Array<long long>>(r, &pool);
+        }
+    }
+}
+
+}  // namespace
+
+// Usage: array_allocator_bench <malloc|monotonic|pool> [threads] [requests_per_thread]
+// Every thread serves requests with its own resource, so only malloc is shared between them.
+int main(const int argc, char* argv[]) {
+    const char* resource = argc > 1 ? argv[1] : "malloc";
+    if (std::strcmp(resource, "malloc") != 0 && std::strcmp(resource, "monotonic") != 0 &&
+        std::strcmp(resource, "pool") != 0) {
+        std::cerr << "Usage: " << argv[0] << " <malloc|monotonic|pool> [threads] [requests_per_thread]\n";
+        return 1;
+    }
+    const int threads = argc > 2 ? std::atoi(argv[2]) : static_cast<int>(std::thread::hardware_concurrency());
+    const int requests = argc > 3 ? std::atoi(argv[3]) : 100000;
+    std::vector<long long> sums(threads);
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back(work, resource, requests, std::ref(sums[t]));
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    long long total = 0;
+    for (const long long sum : sums) {
+        total += sum;
+    }
+    std::cout << resource << " on " << threads << " threads: "
+              << static_cast<double>(threads) * requests / elapsed.count() / 1e6 << " M requests/s (checksum "
+              << total << ")\n";
+    return 0;
+}
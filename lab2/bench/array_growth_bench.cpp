@@ -0,0 +1,59 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <sys/resource.h>
+
+#include "array/array.h"
+
+// Appends to many arrays at once, round-robin, the way per-request buffers fill up: each array
+// ends up with between 1 and 2 * average_size elements.
+template<typename GrowthPolicy>
+void run(const char* name, const int arrays, const int average_size) {
+    const auto start = std::chrono::steady_clock::now();
+    auto pool = std::make_unique<Array<long long, GrowthPolicy>[]>(arrays);
+    long long pushes = 0;
+    for (int round = 0; round < 2 * average_size; ++round) {
+        for (int i = 0; i < arrays; ++i) {
+            // A cheap hash keeps the final sizes spread without a random generator in the loop.
+            if (round < 1 + static_cast<int>((i * 2654435761u >> 7) % (2 * average_size))) {
+                pool[i].insert(round);
+                ++pushes;
+            }
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    long long slack = 0;
+    for (int i = 0; i < arrays; ++i) {
+        slack += pool[i].capacity() - pool[i].size();
+    }
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    std::cout << name << ": " << pushes / elapsed.count() / 1e6 << " M pushes/s, peak RSS "
+              << usage.ru_maxrss / 1024 << " MiB, unused capacity "
+              << 100.0 * static_cast<double>(slack) / static_cast<double>(pushes + slack) << "%\n";
+}
+
+// Usage: array_growth_bench <x2|x1.5|size-class|chunk> [arrays] [average_size]
+// Peak RSS is per process, so run one policy per invocation.
+int main(const int argc, char* argv[]) {
+    const int arrays = argc > 2 ? std::atoi(argv[2]) : 100000;
+    const int average_size = argc > 3 ? std::atoi(argv[3]) : 200;
+    const char* policy = argc > 1 ? argv[1] : "x2";
+    if (std::strcmp(policy, "x2") == 0) {
+        run<GeometricGrowth<2>>(policy, arrays, average_size);
+    } else if (std::strcmp(policy, "x1.5") == 0) {
+        run<GeometricGrowth<3, 2>>(policy, arrays, average_size);
+    } else if (std::strcmp(policy, "size-class") == 0) {
+        run<SizeClassGrowth>(policy, arrays, average_size);
+    } else if (std::strcmp(policy, "chunk") == 0) {
+        run<ChunkGrowth<64>>(policy, arrays, average_size);
+    } else {
+        std::cerr << "Usage: " << argv[0] << " <x2|x1.5|size-class|chunk> [arrays] [average_size]\n";
+        return 1;
+    }
+    return 0;
+}
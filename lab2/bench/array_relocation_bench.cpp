@@ -0,0 +1,98 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "array/array.h"
+#include "array/trivially_relocatable.h"
+
+namespace {
+
+// Owns a heap string through a pointer, like most handle types: moving it is copying the pointer,
+// but it is not trivially copyable, so Array only relocates it with memmove once it opts in.
+template<bool Relocatable>
+struct Owned {
+    std::string* value;
+
+    explicit Owned(std::string value) : value(new std::string(std::move(value))) {}
+    Owned(const Owned& other) : value(new std::string(*other.value)) {}
+    Owned(Owned&& other) noexcept : value(std::exchange(other.value, nullptr)) {}
+    Owned& operator=(const Owned&) = delete;
+    ~Owned() { delete value; }
+};
+
+template<typename T>
+T makeValue(int i);
+
+template<>
+int makeValue<int>(const int i) {
+    return i;
+}
+
+// Past the 15 characters std::string keeps inline, so every element owns a heap block.
+template<>
+std::string makeValue<std::string>(const int i) {
+    return "a string too long to stay inline " + std::to_string(i);
+}
+
+template<>
+Owned<false> makeValue<Owned<false>>(const int i) {
+    return Owned<false>(makeValue<std::string>(i));
+}
+
+template<>
+Owned<true> makeValue<Owned<true>>(const int i) {
+    return Owned<true>(makeValue<std::string>(i));
+}
+
+template<typename F>
+double nanosecondsPer(const int count, F&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / count;
+}
+
+template<typename T>
+void run(const char* name, const int size) {
+    Array<T> front;
+    const double insert = nanosecondsPer(size, [&] {
+        for (int i = 0; i < size; ++i) {
+            front.insert(0, makeValue<T>(i));
+        }
+    });
+    const double remove = nanosecondsPer(size, [&] {
+        while (front.size() > 0) {
+            front.remove(0);
+        }
+    });
+    int appended = 0;
+    const double append = nanosecondsPer(100 * size, [&] {
+        for (int round = 0; round < 100; ++round) {
+            Array<T> back;
+            for (int i = 0; i < size; ++i) {
+                back.insert(makeValue<T>(i));
+            }
+            appended += back.size();
+        }
+    });
+    std::cout << name << " x " << size << ": insert at front " << insert << " ns, remove from front " << remove
+              << " ns, append " << append << " ns per element (" << appended << " appended)\n";
+}
+
+}  // namespace
+
+template<>
+struct IsTriviallyRelocatable<Owned<true>> : std::true_type {};
+
+// Usage: array_relocation_bench [size]
+int main(const int argc, char* argv[]) {
+    const int size = argc > 1 ? std::atoi(argv[1]) : 20000;
+    run<int>("Array<int>", size);
+    run<std::string>("Array<std::string>", size);
+    run<Owned<false>>("Array<Owned>", size);
+    run<Owned<true>>("Array<Owned> (relocatable)", size);
+    return 0;
+}
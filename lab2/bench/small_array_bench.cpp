@@ -0,0 +1,56 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "array/array.h"
+#include "array/small_array.h"
+
+namespace {
+
+template<typename T>
+T makeValue(int i);
+
+template<>
+int makeValue<int>(const int i) {
+    return i;
+}
+
+// Short enough for std::string to keep inline, so only the arrays allocate.
+template<>
+std::string makeValue<std::string>(const int i) {
+    return std::to_string(i);
+}
+
+// Builds and drops arrays of 0 to max_size - 1 elements, the sizes most of ours have.
+template<typename ArrayType>
+void run(const char* name, const int arrays, const int max_size) {
+    using T = std::remove_cvref_t<decltype(std::declval<ArrayType&>()[0])>;
+    long long elements = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int a = 0; a < arrays; ++a) {
+        ArrayType arr;
+        const int size = a % max_size;
+        for (int i = 0; i < size; ++i) {
+            arr.insert(makeValue<T>(i));
+        }
+        elements += arr.size();
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << elapsed.count() / arrays << " ns per array (" << elements << " elements)\n";
+}
+
+}  // namespace
+
+// Usage: small_array_bench [arrays] [max_size]
+int main(const int argc, char* argv[]) {
+    const int arrays = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    const int max_size = argc > 2 ? std::atoi(argv[2]) : 16;
+    run<Array<int>>("Array<int>", arrays, max_size);
+    run<SmallArray<int, 16>>("SmallArray<int, 16>", arrays, max_size);
+    run<Array<std::string>>("Array<std::string>", arrays, max_size);
+    run<SmallArray<std::string, 16>>("SmallArray<std::string, 16>", arrays, max_size);
+    run<Array<int>>("Array<int>, empty", arrays, 1);
+    run<SmallArray<int, 16>>("SmallArray<int, 16>, empty", arrays, 1);
+    return 0;
+}
@@ -4,9 +4,11 @@
 
 #include <gtest/gtest.h>
 
+#include <memory_resource>
 #include <utility>
 
 #include "array/array.h"
+#include "array/small_array.h"
 
 // Test default constructor
 TEST(ArrayTest, DefaultConstructor) {
@@ -215,3 +217,253 @@ TEST(ArrayTest, Resize) {
     EXPECT_EQ(arr[1], 2);
     EXPECT_EQ(arr[2], 3);
 }
+
+
+TEST(ArrayTest, MovedFromArrayGrows) {
+    Array<int> arr;
+    Array<int> arrMoved = std::move(arr);
+    arr.insert(42);
+    EXPECT_EQ(arr.size(), 1);
+    EXPECT_EQ(arr[0], 42);
+}
+
+TEST(ArrayTest, Reserve) {
+    Array<int> arr(2);
+    arr.insert(1);
+    arr.reserve(100);
+    EXPECT_EQ(arr.capacity(), 100);
+    EXPECT_EQ(arr[0], 1);
+    arr.reserve(10);
+    EXPECT_EQ(arr.capacity(), 100);
+}
+
+TEST(ArrayTest, ShrinkToFit) {
+    Array<TestStruct> arr;
+    arr.insert(TestStruct("abacaba"));
+    arr.insert(TestStruct("qwerty"));
+    arr.shrink_to_fit();
+    EXPECT_EQ(arr.capacity(), 2);
+    EXPECT_EQ(arr[1].s, "qwerty");
+    arr.remove(0);
+    arr.remove(0);
+    arr.shrink_to_fit();
+    EXPECT_EQ(arr.capacity(), 0);
+    arr.insert(TestStruct("abacaba"));
+    EXPECT_EQ(arr[0].s, "abacaba");
+}
+
+TEST(ArrayTest, GeometricGrowthFactor) {
+    Array<int, GeometricGrowth<3, 2>> arr(4);
+    for (int i = 0; i < 5; ++i) {
+        arr.insert(i);
+    }
+    EXPECT_EQ(arr.capacity(), 6);
+    EXPECT_EQ(arr[4], 4);
+}
+
+TEST(ArrayTest, SizeClassGrowth) {
+    EXPECT_EQ(SizeClassGrowth::sizeClass(1), 8);
+    EXPECT_EQ(SizeClassGrowth::sizeClass(100), 112);
+    EXPECT_EQ(SizeClassGrowth::sizeClass(129), 160);
+    EXPECT_EQ(SizeClassGrowth::sizeClass(257), 320);
+    EXPECT_EQ(SizeClassGrowth::sizeClass(4096), 4096);
+    // 8 ints grow to 12, 48 bytes: exactly a size class.
+    Array<int, SizeClassGrowth> arr;
+    for (int i = 0; i < 9; ++i) {
+        arr.insert(i);
+    }
+    EXPECT_EQ(arr.capacity(), 12);
+    // 12 doubles grow to 18, 144 bytes, rounded up to 160.
+    Array<double, SizeClassGrowth> doubles(12);
+    for (int i = 0; i < 13; ++i) {
+        doubles.insert(i);
+    }
+    EXPECT_EQ(doubles.capacity(), 20);
+}
+
+TEST(ArrayTest, ChunkGrowth) {
+    Array<int, ChunkGrowth<16>> arr(4);
+    for (int i = 0; i < 40; ++i) {
+        arr.insert(i);
+    }
+    EXPECT_EQ(arr.capacity(), 52);
+    EXPECT_EQ(arr[39], 39);
+}
+
+
+TEST(ArrayTest, InsertRemoveMiddleTrivial) {
+    Array<int> arr(4);
+    for (int i = 0; i < 10; ++i) {
+        arr.insert(i);
+    }
+    arr.insert(5, 42);
+    arr.remove(2);
+    const int expected[] = {0, 1, 3, 4, 42, 5, 6, 7, 8, 9};
+    ASSERT_EQ(arr.size(), 10);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(arr[i], expected[i]);
+    }
+}
+
+// Owns its string through a pointer and counts the live ones; relocatable by opting in.
+struct Relocated {
+    static int alive;
+    std::string* s;
+    explicit Relocated(const std::string& val) : s(new std::string(val)) { ++alive; }
+    Relocated(const Relocated& other) : s(new std::string(*other.s)) { ++alive; }
+    ~Relocated() {
+        delete s;
+        --alive;
+    }
+};
+
+int Relocated::alive = 0;
+
+template<>
+struct IsTriviallyRelocatable<Relocated> : std::true_type {};
+
+TEST(ArrayTest, TriviallyRelocatableType) {
+    static_assert(kIsTriviallyRelocatable<int> && !kIsTriviallyRelocatable<std::string>);
+    {
+        Array<Relocated> arr(2);
+        for (int i = 0; i < 10; ++i) {
+            arr.insert(0, Relocated(std::to_string(i)));
+        }
+        arr.remove(3);
+        arr.shrink_to_fit();
+        EXPECT_EQ(Relocated::alive, 9);
+        EXPECT_EQ(*arr[0].s, "9");
+        EXPECT_EQ(*arr[3].s, "5");
+        EXPECT_EQ(*arr[8].s, "0");
+    }
+    EXPECT_EQ(Relocated::alive, 0);
+}
+
+
+TEST(ArrayTest, MonotonicResource) {
+    char buffer[1024];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    pmr::Array<int> arr(4, &arena);
+    for (int i = 0; i < 20; ++i) {
+        arr.insert(0, i);
+    }
+    EXPECT_EQ(arr.get_allocator().resource(), &arena);
+    EXPECT_EQ(arr[0], 19);
+    EXPECT_EQ(arr[19], 0);
+    // The copy comes from the default resource, not the arena.
+    const pmr::Array<int> copy = arr;
+    EXPECT_EQ(copy.get_allocator().resource(), std::pmr::get_default_resource());
+    EXPECT_EQ(copy[5], 14);
+}
+
+TEST(ArrayTest, StandardAllocator) {
+    Array<TestStruct, GeometricGrowth<2>, std::allocator<TestStruct>> arr(1);
+    arr.insert(TestStruct("abacaba"));
+    arr.insert(0, TestStruct("qwerty"));
+    auto moved = std::move(arr);
+    EXPECT_EQ(moved.size(), 2);
+    EXPECT_EQ(moved[0].s, "qwerty");
+    EXPECT_EQ(arr.size(), 0);
+}
+
+// Each instance is a separate heap that does not follow the array on assignment.
+template<typename T>
+struct TaggedAllocator {
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::false_type;
+    int tag;
+    explicit TaggedAllocator(int tag) : tag(tag) {}
+    template<typename U>
+    TaggedAllocator(const TaggedAllocator<U>& other) : tag(other.tag) {}
+    T* allocate(std::size_t n) { return std::allocator<T>().allocate(n); }
+    void deallocate(T* p, std::size_t n) { std::allocator<T>().deallocate(p, n); }
+    bool operator==(const TaggedAllocator& other) const { return tag == other.tag; }
+};
+
+TEST(ArrayTest, MoveAssignBetweenAllocators) {
+    using TaggedArray = Array<TestStruct, GeometricGrowth<2>, TaggedAllocator<TestStruct>>;
+    TaggedArray first(TaggedAllocator<TestStruct>(1));
+    TaggedArray second(TaggedAllocator<TestStruct>(2));
+    first.insert(TestStruct("abacaba"));
+    second = std::move(first);
+    EXPECT_EQ(second.get_allocator().tag, 2);
+    EXPECT_EQ(second.size(), 1);
+    EXPECT_EQ(second[0].s, "abacaba");
+    EXPECT_EQ(first.size(), 0);
+    first = second;
+    EXPECT_EQ(first.get_allocator().tag, 1);
+    EXPECT_EQ(first[0].s, "abacaba");
+}
+
+
+TEST(SmallArrayTest, StaysInline) {
+    static_assert(sizeof(Array<int>) == sizeof(int*) + 2 * sizeof(int));
+    SmallArray<int, 4> arr;
+    EXPECT_EQ(arr.capacity(), 4);
+    for (int i = 0; i < 4; ++i) {
+        arr.insert(0, i);
+    }
+    EXPECT_EQ(arr.capacity(), 4);
+    EXPECT_EQ(arr[0], 3);
+    EXPECT_EQ(arr[3], 0);
+}
+
+TEST(SmallArrayTest, SpillsAndComesBack) {
+    SmallArray<TestStruct, 2> arr;
+    for (int i = 0; i < 5; ++i) {
+        arr.insert(TestStruct(std::to_string(i)));
+    }
+    EXPECT_EQ(arr.capacity(), 8);
+    arr.remove(0);
+    arr.remove(0);
+    arr.remove(0);
+    arr.shrink_to_fit();
+    EXPECT_EQ(arr.capacity(), 2);
+    EXPECT_EQ(arr[0].s, "3");
+    EXPECT_EQ(arr[1].s, "4");
+    const SmallArray<TestStruct, 2> big(16);
+    EXPECT_EQ(big.capacity(), 16);
+}
+
+TEST(SmallArrayTest, CopyAndMove) {
+    SmallArray<TestStruct, 4> inlined;
+    inlined.insert(TestStruct("abacaba"));
+    SmallArray<TestStruct, 4> spilled;
+    for (int i = 0; i < 6; ++i) {
+        spilled.insert(TestStruct(std::to_string(i)));
+    }
+    SmallArray<TestStruct, 4> copy = inlined;
+    EXPECT_EQ(copy[0].s, "abacaba");
+    SmallArray<TestStruct, 4> moved = std::move(inlined);
+    EXPECT_EQ(moved.size(), 1);
+    EXPECT_EQ(moved[0].s, "abacaba");
+    EXPECT_EQ(inlined.size(), 0);
+    inlined.insert(TestStruct("qwerty"));
+    EXPECT_EQ(inlined[0].s, "qwerty");
+
+    moved = std::move(spilled);
+    EXPECT_EQ(moved.size(), 6);
+    EXPECT_EQ(moved[5].s, "5");
+    EXPECT_EQ(spilled.size(), 0);
+    EXPECT_EQ(spilled.capacity(), 4);
+    moved = copy;
+    EXPECT_EQ(moved.size(), 1);
+    EXPECT_EQ(moved[0].s, "abacaba");
+    copy = moved;
+    copy = std::move(moved);
+    EXPECT_EQ(copy[0].s, "abacaba");
+}
+
+TEST(SmallArrayTest, Iterators) {
+    SmallArray<int, 8> arr;
+    for (int i = 0; i < 5; ++i) {
+        arr.insert(i);
+    }
+    int expected = 0;
+    for (auto it = arr.iterator(); it.hasNext(); it.next()) {
+        EXPECT_EQ(it.get(), expected++);
+    }
+    EXPECT_EQ(expected, 5);
+    auto it = arr.constIterator();
+    EXPECT_EQ(it.get(), 0);
+}